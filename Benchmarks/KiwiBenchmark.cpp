@@ -0,0 +1,573 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+// The benchmarks of the patcher. The program drives the real classes without any window and
+// prints the results in the JSON format on the standard output, the messages of the console
+// are printed when the library is compiled with DEBUG or NO_GUI so it should be compiled without.
+// Usage : KiwiBenchmark [scale], the scale multiplies the number of iterations (1 by default).
+
+#include "../KiwiPatcher.h"
+#include "../KiwiPatcherController.h"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Kiwi;
+
+namespace Benchmark
+{
+    // ================================================================================ //
+    //                                      OBJECTS                                     //
+    // ================================================================================ //
+    
+    //! An object that forwards the messages from its inlet to its outlet.
+    class Pass : public Object
+    {
+    public:
+        ulong count;
+        
+        Pass(Infos const& infos) : Object(infos, Tag::create("bench.pass")), count(0)
+        {
+            addInlet(Io::Message, Io::Hot);
+            addOutlet(Io::Message);
+        }
+        
+        void receive(const ulong index, Vector const& atoms) override
+        {
+            count++;
+            send(0, atoms);
+        }
+        
+        void receiveDouble(const ulong index, const double value) override
+        {
+            count++;
+            sendDouble(0, value);
+        }
+        
+        using Object::send;
+        using Object::sendDouble;
+    };
+    
+    //! An object that only counts the messages.
+    class Sink : public Object
+    {
+    public:
+        ulong count;
+        
+        Sink(Infos const& infos) : Object(infos, Tag::create("bench.sink")), count(0)
+        {
+            addInlet(Io::Message, Io::Hot);
+        }
+        
+        void receive(const ulong index, Vector const& atoms) override
+        {
+            count++;
+        }
+        
+        void receiveDouble(const ulong index, const double value) override
+        {
+            count++;
+        }
+    };
+    
+    //! An object with two inlets that records the inlets of the messages it receives.
+    class Pair : public Object
+    {
+    public:
+        vector<ulong> inlets;
+        
+        Pair(Infos const& infos) : Object(infos, Tag::create("bench.pair"))
+        {
+            addInlet(Io::Message, Io::Hot);
+            addInlet(Io::Message, Io::Hot);
+        }
+        
+        void receive(const ulong index, Vector const& atoms) override
+        {
+            inlets.push_back(index);
+        }
+        
+        using Object::removeInlet;
+    };
+    
+    //! An object with a larger prototype used to measure the registration in the factory.
+    class Heavy : public Object
+    {
+    public:
+        Heavy(Infos const& infos) : Object(infos, Tag::create("bench.heavy"))
+        {
+            for(ulong i = 0; i < 8; i++)
+            {
+                addInlet(Io::Message, Io::Hot);
+                addOutlet(Io::Message);
+            }
+        }
+        
+        void receive(const ulong index, Vector const& atoms) override {}
+    };
+    
+    //! An object whose name is only known by its prototype, like most of the external objects.
+    template <ulong N> class Anonymous : public Box
+    {
+    public:
+        Anonymous(Infos const& infos) : Box(infos, Tag::create("bench.object." + to_string(N)))
+        {
+            addInlet(Io::Message, Io::Hot);
+            addOutlet(Io::Message);
+        }
+        
+        void receive(const ulong index, Vector const& atoms) override {}
+    };
+    
+    //! The same object with a name trait, the factory doesn't create its prototype.
+    template <ulong N> class Named : public Anonymous<N>
+    {
+    public:
+        Named(Infos const& infos) : Anonymous<N>(infos) {}
+        
+        static sTag getClassName()
+        {
+            return Tag::create("bench.object." + to_string(N));
+        }
+    };
+    
+    //! Add or remove the classes from N - 1 to 0 in the factory.
+    template <template <ulong> class T, ulong N> struct Registrar
+    {
+        static void add()
+        {
+            Factory::add<T<N - 1>>();
+            Registrar<T, N - 1>::add();
+        }
+    };
+    
+    template <template <ulong> class T> struct Registrar<T, 0>
+    {
+        static void add() {}
+    };
+    
+    static void removeObjects(const ulong size)
+    {
+        for(ulong i = 0; i < size; i++)
+        {
+            Factory::remove(Tag::create("bench.object." + to_string(i)));
+        }
+    }
+    
+    // ================================================================================ //
+    //                                      RESULTS                                     //
+    // ================================================================================ //
+    
+    struct Result
+    {
+        string  name;
+        string  parameters;
+        ulong   iterations;
+        double  nanoseconds;
+    };
+    
+    static vector<Result>& getResults()
+    {
+        static vector<Result> _results;
+        return _results;
+    }
+    
+    //! Measure a function that runs a number of operations, a first call warms up the caches and the pools.
+    template<class Function> void measure(string const& name, string const& parameters, const ulong iterations, Function function)
+    {
+        typedef chrono::steady_clock Clock;
+        function(iterations / 10 + 1);
+        const Clock::time_point start = Clock::now();
+        function(iterations);
+        const double elapsed = double(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count());
+        getResults().push_back({name, parameters, iterations, elapsed / double(iterations)});
+    }
+    
+    static void print()
+    {
+        printf("{\n  \"benchmarks\": [\n");
+        vector<Result> const& results = getResults();
+        for(vector<Result>::size_type i = 0; i < results.size(); i++)
+        {
+            Result const& result = results[i];
+            printf("    {\"name\": \"%s\", \"parameters\": {%s}, \"iterations\": %lu, \"ns_per_op\": %.3f, \"ops_per_second\": %.1f}%s\n",
+                   result.name.c_str(), result.parameters.c_str(), (unsigned long)result.iterations,
+                   result.nanoseconds, result.nanoseconds > 0. ? 1e9 / result.nanoseconds : 0., i + 1 < results.size() ? "," : "");
+        }
+        printf("  ]\n}\n");
+    }
+    
+    // ================================================================================ //
+    //                                      PATCHES                                     //
+    // ================================================================================ //
+    
+    static Dico createObjectDico(const ulong id, string const& name)
+    {
+        Dico dico;
+        dico[Tags::id]   = (long)id;
+        dico[Tags::name] = Tag::create(name);
+        dico[Tags::text] = Tag::create(name);
+        return dico;
+    }
+    
+    static Dico createLinkDico(const ulong from, const ulong outlet, const ulong to, const ulong inlet)
+    {
+        Dico dico;
+        dico[Tags::from] = {(long)from, (long)outlet};
+        dico[Tags::to]   = {(long)to, (long)inlet};
+        return dico;
+    }
+    
+    //! A chain of objects, each object is linked to the next one and to nlinks - 1 other objects.
+    static Dico createPatch(const ulong nobjects, const ulong nlinks)
+    {
+        Vector objects, links;
+        for(ulong i = 1; i <= nobjects; i++)
+        {
+            objects.push_back(createObjectDico(i, "bench.pass"));
+        }
+        for(ulong i = 1; i < nobjects; i++)
+        {
+            for(ulong j = 0; j < nlinks && i + j < nobjects; j++)
+            {
+                links.push_back(createLinkDico(i, 0, i + j + 1, 0));
+            }
+        }
+        Dico dico;
+        dico[Tags::objects] = objects;
+        dico[Tags::links]   = links;
+        return dico;
+    }
+    
+    //! A source linked to a number of sinks, the source is the first object of the patcher.
+    static sPatcher createFanOut(sInstance instance, const ulong nsinks)
+    {
+        Vector objects, links;
+        objects.push_back(createObjectDico(1, "bench.pass"));
+        for(ulong i = 0; i < nsinks; i++)
+        {
+            objects.push_back(createObjectDico(i + 2, "bench.sink"));
+            links.push_back(createLinkDico(1, 0, i + 2, 0));
+        }
+        Dico dico;
+        dico[Tags::objects] = objects;
+        dico[Tags::links]   = links;
+        sPatcher patcher = instance->createPatcher();
+        patcher->add(dico);
+        return patcher;
+    }
+    
+    //! A chain of objects that ends with a sink, the first object of the patcher starts the chain.
+    static sPatcher createChain(sInstance instance, const ulong depth)
+    {
+        Vector objects, links;
+        for(ulong i = 1; i <= depth; i++)
+        {
+            objects.push_back(createObjectDico(i, "bench.pass"));
+            links.push_back(createLinkDico(i, 0, i + 1, 0));
+        }
+        objects.push_back(createObjectDico(depth + 1, "bench.sink"));
+        Dico dico;
+        dico[Tags::objects] = objects;
+        dico[Tags::links]   = links;
+        sPatcher patcher = instance->createPatcher();
+        patcher->add(dico);
+        return patcher;
+    }
+    
+    // ================================================================================ //
+    //                                      CHECKS                                      //
+    // ================================================================================ //
+    
+    static bool check(const bool condition, string const& name)
+    {
+        if(!condition)
+        {
+            fprintf(stderr, "check failed : %s\n", name.c_str());
+        }
+        return condition;
+    }
+    
+    //! Two links into the same object, the link of the higher inlet is created first, then the lower inlet is removed.
+    static bool checkRemoveInlet(sInstance instance)
+    {
+        Vector objects, links;
+        objects.push_back(createObjectDico(1, "bench.pass"));
+        objects.push_back(createObjectDico(2, "bench.pair"));
+        links.push_back(createLinkDico(1, 0, 2, 1));
+        links.push_back(createLinkDico(1, 0, 2, 0));
+        Dico dico;
+        dico[Tags::objects] = objects;
+        dico[Tags::links]   = links;
+        sPatcher patcher = instance->createPatcher();
+        patcher->add(dico);
+        
+        const vector<sObject> created = patcher->getObjects();
+        shared_ptr<Pass> source = dynamic_pointer_cast<Pass>(created[0]);
+        shared_ptr<Pair> target = dynamic_pointer_cast<Pair>(created[1]);
+        target->removeInlet(0);
+        source->send(0, {1.});
+        
+        const vector<sLink> remaining = patcher->getLinks();
+        const Object::sOutlet outlet  = source->getOutlet(0);
+        bool valid = check(remaining.size() == 1 && remaining[0]->getInletIndex() == 0, "remove_inlet.links");
+        valid = check(outlet->getNumberOfConnection() == 1 && outlet->getIndex(0) == 0, "remove_inlet.connections") && valid;
+        valid = check(target->inlets.size() == 1 && target->inlets[0] == 0, "remove_inlet.dispatch") && valid;
+        patcher->remove(target);
+        valid = check(outlet->getNumberOfConnection() == 0, "remove_inlet.disconnect") && valid;
+        instance->removePatcher(patcher);
+        return valid;
+    }
+    
+    //! Batches of different sizes run back to back, each index must be run once per batch.
+    static bool checkExecutor(const ulong scale)
+    {
+        Executor executor(Executor::getDefaultNumberOfThreads() ? Executor::getDefaultNumberOfThreads() : 1, 50);
+        vector<atomic_ulong> counts(64);
+        for(auto& count : counts)
+        {
+            count = 0;
+        }
+        for(ulong i = 0; i < 100000 * scale; i++)
+        {
+            const ulong size = i % counts.size() + 1;
+            executor.parallel(size, [&counts](ulong index)
+            {
+                counts[index]++;
+            });
+            for(ulong j = 0; j < size; j++)
+            {
+                if(counts[j].exchange(0) != 1)
+                {
+                    return check(false, "executor.batches");
+                }
+            }
+        }
+        return true;
+    }
+    
+    static string parameters(string const& name, const ulong value)
+    {
+        return "\"" + name + "\": " + to_string(value);
+    }
+    
+    static string mode()
+    {
+        return Object::Outlet::isIterative() ? "\"dispatch\": \"iterative\"" : "\"dispatch\": \"recursive\"";
+    }
+    
+    // ================================================================================ //
+    //                                      BENCHMARKS                                  //
+    // ================================================================================ //
+    
+    static void patcherAdd(sInstance instance, const ulong scale)
+    {
+        for(ulong nobjects : {100ul, 1000ul, 10000ul})
+        {
+            for(ulong nlinks : {1ul, 4ul})
+            {
+                const Dico dico = createPatch(nobjects, nlinks);
+                measure("patcher_add", parameters("objects", nobjects) + ", " + parameters("links_per_object", nlinks), (10000ul * scale) / nobjects + 1, [&](ulong iterations)
+                {
+                    for(ulong i = 0; i < iterations; i++)
+                    {
+                        sPatcher patcher = instance->createPatcher();
+                        patcher->add(dico);
+                        instance->removePatcher(patcher);
+                    }
+                });
+            }
+        }
+    }
+    
+    static void patcherGetObjectWithId(sInstance instance, const ulong scale)
+    {
+        const ulong nobjects = 1000;
+        sPatcher patcher = instance->createPatcher();
+        patcher->add(createPatch(nobjects, 0));
+        vector<ulong> ids;
+        for(auto object : patcher->getObjects())
+        {
+            ids.push_back(object->getId());
+        }
+        measure("patcher_get_object_with_id", parameters("objects", nobjects), 1000000ul * scale, [&](ulong iterations)
+        {
+            ulong found = 0;
+            for(ulong i = 0; i < iterations; i++)
+            {
+                found += bool(patcher->getObjectWithId(ids[i % ids.size()]));
+            }
+            if(found != iterations)
+            {
+                fprintf(stderr, "patcher_get_object_with_id : %lu objects missing\n", (unsigned long)(iterations - found));
+            }
+        });
+        instance->removePatcher(patcher);
+    }
+    
+    static void outletSend(sInstance instance, const ulong scale)
+    {
+        for(bool iterative : {false, true})
+        {
+            Object::Outlet::setIterative(iterative);
+            for(ulong nsinks : {1ul, 16ul, 256ul})
+            {
+                sPatcher patcher = createFanOut(instance, nsinks);
+                shared_ptr<Pass> source = dynamic_pointer_cast<Pass>(patcher->getObjects().front());
+                const ulong iterations = (1000000ul * scale) / nsinks + 1;
+                measure("outlet_send_fan_out", mode() + ", " + parameters("connections", nsinks), iterations, [&](ulong iterations)
+                {
+                    for(ulong i = 0; i < iterations; i++)
+                    {
+                        source->send(0, {1.});
+                    }
+                });
+                measure("outlet_send_double_fan_out", mode() + ", " + parameters("connections", nsinks), iterations, [&](ulong iterations)
+                {
+                    for(ulong i = 0; i < iterations; i++)
+                    {
+                        source->sendDouble(0, 1.);
+                    }
+                });
+                instance->removePatcher(patcher);
+            }
+            
+            for(ulong depth : {16ul, 128ul})
+            {
+                sPatcher patcher = createChain(instance, depth);
+                shared_ptr<Pass> source = dynamic_pointer_cast<Pass>(patcher->getObjects().front());
+                measure("outlet_send_chain", mode() + ", " + parameters("depth", depth), (1000000ul * scale) / depth + 1, [&](ulong iterations)
+                {
+                    for(ulong i = 0; i < iterations; i++)
+                    {
+                        source->send(0, {1.});
+                    }
+                });
+                instance->removePatcher(patcher);
+            }
+        }
+        Object::Outlet::setIterative(false);
+    }
+    
+    static void factory(sInstance instance, const ulong scale)
+    {
+        measure("factory_add_remove", "", 10000ul * scale, [&](ulong iterations)
+        {
+            const sTag name = Tag::create("bench.heavy");
+            for(ulong i = 0; i < iterations; i++)
+            {
+                Factory::add<Heavy>();
+                Factory::remove(name);
+            }
+        });
+        
+        // The registration of the external objects at startup, with and without the name trait.
+        measure("factory_register_prototype", parameters("classes", 400), scale, [&](ulong iterations)
+        {
+            for(ulong i = 0; i < iterations; i++)
+            {
+                Registrar<Anonymous, 400>::add();
+                removeObjects(400);
+            }
+        });
+        measure("factory_register_name_trait", parameters("classes", 400), scale, [&](ulong iterations)
+        {
+            for(ulong i = 0; i < iterations; i++)
+            {
+                Registrar<Named, 400>::add();
+                removeObjects(400);
+            }
+        });
+        
+        sPatcher patcher = instance->createPatcher();
+        const sTag name = Tag::create("bench.pass");
+        measure("factory_create", "", 100000ul * scale, [&](ulong iterations)
+        {
+            for(ulong i = 0; i < iterations; i++)
+            {
+                Factory::create(name, Infos(instance, patcher, i + 1, name, "bench.pass", Dico(), Vector()));
+            }
+        });
+        instance->removePatcher(patcher);
+    }
+    
+    static void consolePost(const ulong scale)
+    {
+        measure("console_post", "", 100000ul * scale, [&](ulong iterations)
+        {
+            for(ulong i = 0; i < iterations; i++)
+            {
+                Console::post("benchmark");
+            }
+        });
+    }
+    
+    static void selection(sInstance instance, const ulong scale)
+    {
+        const ulong nobjects = 1000;
+        sPatcher patcher = instance->createPatcher();
+        patcher->add(createPatch(nobjects, 0));
+        const vector<sObject> objects = patcher->getObjects();
+        Patcher::Controller::Selection selection(patcher, nullptr);
+        measure("selection_add_remove", parameters("objects", nobjects), 100ul * scale, [&](ulong iterations)
+        {
+            for(ulong i = 0; i < iterations; i++)
+            {
+                for(auto object : objects)
+                {
+                    selection.add(object, false);
+                }
+                for(auto object : objects)
+                {
+                    selection.remove(object, false);
+                }
+            }
+        });
+        instance->removePatcher(patcher);
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    const long scale = argc > 1 ? atol(argv[1]) : 1;
+    const ulong factor = scale > 0 ? ulong(scale) : 1;
+    
+    Factory::add<Benchmark::Pass>();
+    Factory::add<Benchmark::Sink>();
+    Factory::add<Benchmark::Pair>();
+    sInstance instance = Instance::create(nullptr, nullptr, "benchmark");
+    
+    // The checks of the editions that the benchmarks don't cover, the results aren't printed if one fails.
+    if(!Benchmark::checkRemoveInlet(instance) || !Benchmark::checkExecutor(factor))
+    {
+        return 1;
+    }
+    
+    Benchmark::patcherAdd(instance, factor);
+    Benchmark::patcherGetObjectWithId(instance, factor);
+    Benchmark::outletSend(instance, factor);
+    Benchmark::factory(instance, factor);
+    Benchmark::consolePost(factor);
+    Benchmark::selection(instance, factor);
+    Benchmark::print();
+    return 0;
+}
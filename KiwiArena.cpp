@@ -0,0 +1,109 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "KiwiArena.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      ARENA                                       //
+    // ================================================================================ //
+    
+    Arena::Arena() noexcept :
+    m_position(nullptr),
+    m_remaining(0)
+    {
+        for(size_t i = 0; i < maximum / granularity; i++)
+        {
+            m_free[i] = nullptr;
+        }
+    }
+    
+    Arena::~Arena()
+    {
+        m_pages.clear();
+    }
+    
+    void* Arena::allocate(const size_t size, const size_t alignment)
+    {
+        if(alignment > granularity)
+        {
+            // The block is aligned in a larger one and the address of the larger one is stored just before it.
+            char* origin = static_cast<char*>(::operator new(size + alignment + sizeof(void*)));
+            const uintptr_t address = reinterpret_cast<uintptr_t>(origin + sizeof(void*));
+            char* block = origin + sizeof(void*) + (alignment - address % alignment) % alignment;
+            reinterpret_cast<void**>(block)[-1] = origin;
+            return block;
+        }
+        else if(size > maximum)
+        {
+            return ::operator new(size);
+        }
+        const size_t index = size ? (size - 1) / granularity : 0;
+        lock_guard<mutex> guard(m_mutex);
+        Cell* cell = m_free[index];
+        if(cell)
+        {
+            m_free[index] = cell->next;
+            return cell;
+        }
+        
+        const size_t length = (index + 1) * granularity;
+        if(m_remaining < length)
+        {
+            // The rest of the page is too small and is lost, it's at most the largest size class.
+            m_pages.push_back(unique_ptr<char[]>(new char[pagesize]));
+            m_position  = m_pages.back().get();
+            m_remaining = pagesize;
+        }
+        void* block = m_position;
+        m_position  += length;
+        m_remaining -= length;
+        return block;
+    }
+    
+    void Arena::release(void* ptr, const size_t size, const size_t alignment) noexcept
+    {
+        if(alignment > granularity)
+        {
+            ::operator delete(static_cast<void**>(ptr)[-1]);
+            return;
+        }
+        else if(size > maximum)
+        {
+            ::operator delete(ptr);
+            return;
+        }
+        const size_t index = size ? (size - 1) / granularity : 0;
+        lock_guard<mutex> guard(m_mutex);
+        Cell* cell      = static_cast<Cell*>(ptr);
+        cell->next      = m_free[index];
+        m_free[index]   = cell;
+    }
+    
+    ulong Arena::getNumberOfPages() noexcept
+    {
+        lock_guard<mutex> guard(m_mutex);
+        return ulong(m_pages.size());
+    }
+}
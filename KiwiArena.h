@@ -0,0 +1,171 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_ARENA__
+#define __DEF_KIWI_ARENA__
+
+#include "../KiwiCore/KiwiCore.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      ARENA                                       //
+    // ================================================================================ //
+    
+    class Arena;
+    typedef shared_ptr<Arena>   sArena;
+    
+    //! The arena allocates the small blocks of memory of a patcher in large pages.
+    /**
+     The arena cuts large pages of memory into blocks sorted by size classes, the blocks released are kept in a free list of their class and reused by the next allocations of the same size. The pages are only freed with the arena so the objects, the iolets and the links of a patcher are close in memory and destroying a patcher frees its memory in a few calls. The allocator of the arena keeps the arena alive so the blocks allocated by the shared pointers can outlive the patcher.
+     @see Patcher::getArena
+     */
+    class Arena
+    {
+    private:
+        //! @internal A free block is linked to the next free block of its size class.
+        struct Cell
+        {
+            Cell* next;
+        };
+        
+        static const size_t granularity = 16;
+        static const size_t maximum     = 1024;
+        static const size_t pagesize    = 65536;
+        
+        mutex                       m_mutex;
+        vector<unique_ptr<char[]>>  m_pages;
+        char*                       m_position;
+        size_t                      m_remaining;
+        Cell*                       m_free[maximum / granularity];
+        
+    public:
+        
+        //! The allocator of the arena for the standard containers and the shared pointers.
+        template <class T> class Allocator
+        {
+        public:
+            typedef T value_type;
+            
+            sArena arena;
+            
+            //! Constructor.
+            /** The function creates an allocator that uses an arena.
+             @param _arena The arena.
+             */
+            Allocator(sArena _arena) noexcept : arena(_arena)
+            {
+                ;
+            }
+            
+            //! Copy constructor.
+            /** The function creates an allocator that uses the arena of another allocator.
+             @param other The other allocator.
+             */
+            template <class U> Allocator(Allocator<U> const& other) noexcept : arena(other.arena)
+            {
+                ;
+            }
+            
+            //! Allocate an array.
+            /** The function allocates an array in the arena.
+             @param size The number of elements.
+             @return The address of the array.
+             */
+            inline T* allocate(const size_t size)
+            {
+                return static_cast<T*>(arena->allocate(size * sizeof(T), alignof(T)));
+            }
+            
+            //! Release an array.
+            /** The function gives an array back to the arena.
+             @param ptr The address of the array.
+             @param size The number of elements.
+             */
+            inline void deallocate(T* ptr, const size_t size) noexcept
+            {
+                arena->release(ptr, size * sizeof(T), alignof(T));
+            }
+            
+            template <class U> inline bool operator==(Allocator<U> const& other) const noexcept
+            {
+                return arena == other.arena;
+            }
+            
+            template <class U> inline bool operator!=(Allocator<U> const& other) const noexcept
+            {
+                return arena != other.arena;
+            }
+        };
+        
+        //! Constructor.
+        /** The function creates an empty arena, the first page is allocated by the first allocation.
+         */
+        Arena() noexcept;
+        
+        //! Destructor.
+        /** The function frees all the pages of the arena.
+         */
+        ~Arena();
+        
+        //! Allocate a block.
+        /** The function allocates a block in a page of the arena. The blocks bigger than the largest size class are allocated on the heap and the blocks with an extended alignment are aligned in a larger block of the heap.
+         @param size The size of the block.
+         @param alignment The alignment of the block.
+         @return The address of the block.
+         */
+        void* allocate(const size_t size, const size_t alignment);
+        
+        //! Release a block.
+        /** The function gives a block back to the free list of its size class.
+         @param ptr The address of the block.
+         @param size The size of the block.
+         @param alignment The alignment of the block.
+         */
+        void release(void* ptr, const size_t size, const size_t alignment) noexcept;
+        
+        //! Retrieve the number of pages.
+        /** The function retrieves the number of pages allocated by the arena.
+         @return The number of pages.
+         */
+        ulong getNumberOfPages() noexcept;
+        
+        //! Create a shared pointer in an arena.
+        /** The function creates a shared pointer whose object and counters are allocated in the arena or on the heap if there is no arena.
+         @param arena The arena or nullptr.
+         @param arguments The arguments of the constructor.
+         @return The shared pointer.
+         */
+        template <class T, class ...Arguments> static inline shared_ptr<T> create(sArena arena, Arguments&&... arguments)
+        {
+            if(arena)
+            {
+                return allocate_shared<T>(Allocator<T>(arena), forward<Arguments>(arguments)...);
+            }
+            return make_shared<T>(forward<Arguments>(arguments)...);
+        }
+    };
+}
+
+
+#endif
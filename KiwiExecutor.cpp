@@ -0,0 +1,238 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "KiwiExecutor.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      EXECUTOR                                    //
+    // ================================================================================ //
+    
+    static inline uint64_t pack(const uint64_t begin, const uint64_t end) noexcept
+    {
+        return (begin << 32) | end;
+    }
+    
+    Executor::Executor(const ulong nthreads, const ulong spin) :
+    m_ranges(new Range[nthreads + 1]),
+    m_size(nthreads + 1),
+    m_task(nullptr),
+    m_remaining(0),
+    m_generation(0),
+    m_sleeping(0),
+    m_active(0),
+    m_open(false),
+    m_spin(spin),
+    m_running(true),
+    m_semaphore()
+    {
+        for(ulong i = 0; i < m_size; i++)
+        {
+            m_ranges[i].bounds = 0;
+        }
+        for(ulong i = 0; i < nthreads; i++)
+        {
+            m_threads.push_back(thread(&Executor::run, this, i));
+        }
+    }
+    
+    Executor::~Executor()
+    {
+        m_running = false;
+        m_semaphore.post(ulong(m_threads.size()));
+        for(auto& worker : m_threads)
+        {
+            if(worker.joinable())
+            {
+                worker.join();
+            }
+        }
+    }
+    
+    ulong Executor::getDefaultNumberOfThreads() noexcept
+    {
+        const ulong ncores = thread::hardware_concurrency();
+        return ncores > 1 ? ncores - 1 : 0;
+    }
+    
+    bool& Executor::isInside() noexcept
+    {
+        static thread_local bool _inside = false;
+        return _inside;
+    }
+    
+    bool Executor::pop(const ulong slot, ulong& index) noexcept
+    {
+        atomic<uint64_t>& bounds = m_ranges[slot].bounds;
+        uint64_t value = bounds.load(memory_order_acquire);
+        while(true)
+        {
+            const uint64_t begin = value >> 32, end = value & 0xffffffff;
+            if(begin >= end)
+            {
+                return false;
+            }
+            if(bounds.compare_exchange_weak(value, pack(begin + 1, end), memory_order_acq_rel, memory_order_acquire))
+            {
+                index = ulong(begin);
+                return true;
+            }
+        }
+    }
+    
+    bool Executor::steal(const ulong slot, const ulong victim, ulong& index) noexcept
+    {
+        atomic<uint64_t>& bounds = m_ranges[victim].bounds;
+        uint64_t value = bounds.load(memory_order_acquire);
+        while(true)
+        {
+            const uint64_t begin = value >> 32, end = value & 0xffffffff;
+            if(begin >= end)
+            {
+                return false;
+            }
+            
+            // The thief takes the upper half, the first index is run and the others become its range.
+            const uint64_t middle = begin + (end - begin) / 2;
+            if(bounds.compare_exchange_weak(value, pack(begin, middle), memory_order_acq_rel, memory_order_acquire))
+            {
+                index = ulong(middle);
+                if(middle + 1 < end)
+                {
+                    m_ranges[slot].bounds.store(pack(middle + 1, end), memory_order_release);
+                }
+                return true;
+            }
+        }
+    }
+    
+    void Executor::participate(const ulong slot) noexcept
+    {
+        while(true)
+        {
+            ulong index;
+            bool found = pop(slot, index);
+            for(ulong i = 1; !found && i < m_size; i++)
+            {
+                found = steal(slot, (slot + i) % m_size, index);
+            }
+            if(!found)
+            {
+                return;
+            }
+            
+            // The task is read after the index has been taken so it always belongs to the current batch.
+            (*m_task.load(memory_order_acquire))(index);
+            m_remaining.fetch_sub(1, memory_order_release);
+        }
+    }
+    
+    void Executor::run(const ulong slot) noexcept
+    {
+        ulong generation = 0;
+        while(m_running)
+        {
+            // The worker spins a little after a batch because the next one often comes soon.
+            const auto start = chrono::steady_clock::now();
+            const chrono::microseconds spin(m_spin.load(memory_order_relaxed));
+            while(m_running && m_generation == generation && chrono::steady_clock::now() - start < spin)
+            {
+                this_thread::yield();
+            }
+            if(m_running && m_generation == generation)
+            {
+                // The worker is counted before it checks the generation again so a batch started after
+                // the check always posts the semaphore for it. A post for a worker that didn't sleep
+                // only makes a later wait return early and the worker checks the generation again.
+                m_sleeping++;
+                if(m_running && m_generation == generation)
+                {
+                    m_semaphore.wait();
+                }
+                continue;
+            }
+            if(!m_running)
+            {
+                return;
+            }
+            
+            generation = m_generation;
+            isInside() = true;
+            m_active++;
+            if(m_open)
+            {
+                participate(slot);
+            }
+            m_active--;
+            isInside() = false;
+        }
+    }
+    
+    void Executor::parallel(const ulong size, function<void(ulong)> const& task) noexcept
+    {
+        bool& inside = isInside();
+        if(!size)
+        {
+            return;
+        }
+        else if(m_size == 1 || size == 1 || inside || uint64_t(size) > 0xffffffff || !m_batch.try_lock())
+        {
+            for(ulong i = 0; i < size; i++)
+            {
+                task(i);
+            }
+            return;
+        }
+        
+        // The task and the counter are set before the ranges so an index is never taken before them.
+        m_task.store(&task, memory_order_release);
+        m_remaining.store(size, memory_order_release);
+        for(ulong i = 0; i < m_size; i++)
+        {
+            const uint64_t begin = uint64_t(size) * i / m_size, end = uint64_t(size) * (i + 1) / m_size;
+            m_ranges[i].bounds.store(pack(begin, end), memory_order_release);
+        }
+        m_open = true;
+        m_generation++;
+        m_semaphore.post(m_sleeping.exchange(0));
+        
+        inside = true;
+        participate(m_size - 1);
+        inside = false;
+        while(m_remaining.load(memory_order_acquire))
+        {
+            this_thread::yield();
+        }
+        
+        // A worker that still looks for an index can steal from a range and write its own range, so the ranges are
+        // only reused once the batch is closed and the workers that entered it have left.
+        m_open = false;
+        while(m_active.load())
+        {
+            this_thread::yield();
+        }
+        m_batch.unlock();
+    }
+}
+
@@ -0,0 +1,136 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_EXECUTOR__
+#define __DEF_KIWI_EXECUTOR__
+
+#include "KiwiSemaphore.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      EXECUTOR                                    //
+    // ================================================================================ //
+    
+    //! The executor runs independent tasks on a set of worker threads.
+    /**
+     The executor owns a set of worker threads that help the calling thread to run a batch of independent tasks. Each thread starts with a contiguous range of the indices of the tasks and when it has finished its range it steals the upper half of the range of another thread. The ranges are packed in atomic integers so running a batch never locks a mutex and never allocates. The workers spin a little after a batch then sleep on a semaphore that is posted without lock, so the executor can be used from an audio callback; the spin duration should be shorter than the period of the callback. The method returns when all the tasks are done: each task should write its results at its own index and the caller merges them in the order of the indices so the result doesn't depend on the scheduling.
+     @see Instance::tick
+     */
+    class Executor
+    {
+    private:
+        //! @internal The range of indices of a thread, the beginning is in the high bits.
+        struct Range
+        {
+            atomic<uint64_t>    bounds;
+            char                padding[64 - sizeof(atomic<uint64_t>)];
+        };
+        
+        const unique_ptr<Range[]>               m_ranges;
+        const ulong                             m_size;
+        vector<thread>                          m_threads;
+        atomic<const function<void(ulong)>*>    m_task;
+        atomic_ulong                            m_remaining;
+        atomic_ulong                            m_generation;
+        atomic_ulong                            m_sleeping;
+        atomic_ulong                            m_active;
+        atomic_bool                             m_open;
+        atomic_ulong                            m_spin;
+        atomic_bool                             m_running;
+        Semaphore                               m_semaphore;
+        mutex                                   m_batch;
+        
+        //! @internal Retrieve if the current thread is running a task of an executor.
+        static bool& isInside() noexcept;
+        
+        //! @internal Take an index from the range of a thread or steal a part of it.
+        bool pop(const ulong slot, ulong& index) noexcept;
+        bool steal(const ulong slot, const ulong victim, ulong& index) noexcept;
+        
+        //! @internal Run the tasks until all the ranges are empty.
+        /** The workers only run the tasks while the batch is open and they are counted as active, a batch is closed and waits for the active workers before its ranges are reused, so a late thief never writes the ranges of the next batch.
+         */
+        void participate(const ulong slot) noexcept;
+        
+        //! @internal The loop of a worker thread.
+        void run(const ulong slot) noexcept;
+        
+    public:
+        
+        //! Constructor.
+        /** The function starts the worker threads.
+         @param nthreads The number of worker threads, by default the number of cores minus one for the calling thread.
+         @param spin     The duration in microseconds of the spin of the workers after a batch.
+         */
+        Executor(const ulong nthreads = getDefaultNumberOfThreads(), const ulong spin = 100);
+        
+        //! Destructor.
+        /** The function stops and joins the worker threads.
+         */
+        ~Executor();
+        
+        //! Retrieve the default number of worker threads.
+        /** The function retrieves the number of cores minus one.
+         @return The default number of worker threads.
+         */
+        static ulong getDefaultNumberOfThreads() noexcept;
+        
+        //! Retrieve the number of worker threads.
+        /** The function retrieves the number of worker threads.
+         @return The number of worker threads.
+         */
+        inline ulong getNumberOfThreads() const noexcept
+        {
+            return m_size - 1;
+        }
+        
+        //! Set the spin duration of the workers.
+        /** The function sets how long the workers wait for the next batch before they sleep. The workers that sleep need a system call to be woken up, the workers that spin use their cores, so the duration should be bounded by the period of the callback that runs the batches.
+         @param spin The duration in microseconds.
+         */
+        inline void setSpinDuration(const ulong spin) noexcept
+        {
+            m_spin.store(spin, memory_order_relaxed);
+        }
+        
+        //! Retrieve the spin duration of the workers.
+        /** The function retrieves how long the workers wait for the next batch before they sleep.
+         @return The duration in microseconds.
+         */
+        inline ulong getSpinDuration() const noexcept
+        {
+            return m_spin.load(memory_order_relaxed);
+        }
+        
+        //! Run a batch of tasks.
+        /** The function calls the task for each index from zero to the number of tasks minus one with the worker threads and the calling thread and returns when all the calls are done. The task must not throw. If the executor is already running a batch or if the function is called from a task, the tasks are called in order by the calling thread.
+         @param size The number of tasks.
+         @param task The task that receives the index.
+         */
+        void parallel(const ulong size, function<void(ulong)> const& task) noexcept;
+    };
+}
+
+
+#endif
@@ -33,10 +33,9 @@ namespace Kiwi
     
     sObject Factory::create(const sTag name, Infos const& detail)
     {
-        lock_guard<mutex> guard(getMutex());
-        map<sTag, sCreator>& creators(getCreators());
-        auto it = creators.find(name);
-        if(it != creators.end())
+        const Creators* creators = getCreators();
+        auto it = creators->find(name);
+        if(it != creators->end())
         {
             sObject obj = it->second->create(detail);
             if(obj)
@@ -54,26 +53,42 @@ namespace Kiwi
     
     bool Factory::has(const sTag name)
     {
-        lock_guard<mutex> guard(getMutex());
-        map<sTag, sCreator>& creators(getCreators());
-        return creators.find(name) != creators.end();
+        const Creators* creators = getCreators();
+        return creators->find(name) != creators->end();
+    }
+    
+    bool Factory::isDsp(const sTag name)
+    {
+        const Creators* creators = getCreators();
+        auto it = creators->find(name);
+        return it != creators->end() && it->second->isDsp();
     }
     
     void Factory::remove(const sTag name)
     {
         lock_guard<mutex> guard(getMutex());
-        map<sTag, sCreator>& creators(getCreators());
-        creators.erase(name);
+        const Creators* creators = getCreators();
+        if(creators->count(name))
+        {
+            unique_ptr<Creators> updated(new Creators(*creators));
+            updated->erase(name);
+            publish(move(updated));
+        }
     }
     
     vector<sTag> Factory::names()
     {
-        lock_guard<mutex> guard(getMutex());
+        const Creators* creators = getCreators();
         vector<sTag> names;
-        for(auto it : getCreators())
+        names.reserve(creators->size());
+        for(auto const& it : *creators)
         {
             names.push_back(it.first);
         }
+        sort(names.begin(), names.end(), [](sTag const& a, sTag const& b)
+        {
+            return a->getName() < b->getName();
+        });
         return names;
     }
 }
@@ -45,28 +45,90 @@ namespace Kiwi
         public:
             virtual inline ~Creator() noexcept {};
             virtual inline sObject create(Infos const& init) = 0;
+            virtual inline bool isDsp() const noexcept = 0;
         };
         typedef shared_ptr<Creator> sCreator;
         
+        //! The registry of the creators.
+        /** The tags are unique so the registry is hashed on their pointers. A registry is never modified, the add and remove methods publish a new one.
+         */
+        typedef unordered_map<sTag, sCreator>   Creators;
+        typedef unique_ptr<const Creators>      ucCreators;
+        
         //! The full virtual object's creator.
         template <class T> class CreatorTyped : public Creator
         {
         public:
-            inline sObject create(Infos const& init) override {return make_shared<T>(init);}
+            inline sObject create(Infos const& init) override {return Arena::create<T>(init.patcher ? init.patcher->getArena() : nullptr, init);}
+            inline bool isDsp() const noexcept override {return is_base_of<DspNode, T>::value;}
+        };
+        
+        //! Detects if a class gives its name with a static method.
+        /** The class has a name trait if it defines a static method getClassName that returns its default name.
+         */
+        template <class T> class HasClassName
+        {
+            template <class U> static auto test(int) -> decltype(sTag(U::getClassName()), true_type());
+            template <class U> static false_type test(...);
+        public:
+            static const bool value = decltype(test<T>(0))::value;
         };
         
-        //! Retrieves the static map of creators.
-        /** This function retrieves  the static map of creators.
-         @return The map of creators.
+        //! Retrieves the default name of a class with its name trait.
+        template <class T> static inline sTag getDefaultName(true_type)
+        {
+            return T::getClassName();
+        }
+        
+        //! Retrieves the default name of a class by creating a prototype.
+        template <class T> static inline sTag getDefaultName(false_type)
+        {
+            sObject object = make_shared<T>(Infos());
+            return object ? object->getName() : nullptr;
+        }
+        
+        //! Retrieves the static registry of creators.
+        /** This function retrieves the static pointer to the current registry of creators.
+         @return The pointer to the registry of creators.
          */
-        static inline map<sTag, shared_ptr<Creator>>& getCreators() noexcept
+        static inline atomic<const Creators*>& getRegistry() noexcept
         {
-            static map<sTag, sCreator> _creators;
+            static const Creators _empty;
+            static atomic<const Creators*> _creators(&_empty);
             return _creators;
         }
         
+        //! Retrieves the static list of the published registries.
+        /** This function retrieves the list that owns all the registries that have been published. A registry is never deleted because a reader can still use it after it has been replaced, the factory is only modified when the objects are registered so the list stays small. The list must be accessed with the mutex.
+         @return The list of the registries.
+         */
+        static inline vector<ucCreators>& getRegistries() noexcept
+        {
+            static vector<ucCreators> _registries;
+            return _registries;
+        }
+        
+        //! Retrieves the current registry of creators.
+        /** This function retrieves the current registry of creators without locking the factory.
+         @return The registry of creators.
+         */
+        static inline const Creators* getCreators() noexcept
+        {
+            return getRegistry().load(memory_order_acquire);
+        }
+        
+        //! Publishes a new registry of creators.
+        /** This function keeps the registry alive and replaces the current one, it must be called with the mutex.
+         @param creators The new registry of creators.
+         */
+        static inline void publish(ucCreators creators)
+        {
+            getRegistries().push_back(move(creators));
+            getRegistry().store(getRegistries().back().get(), memory_order_release);
+        }
+        
         //! Retrieves the static mutex.
-        /** This function retrieves the static mutex.
+        /** This function retrieves the static mutex that serializes the modifications of the registry.
          @return The mutex.
          */
         static inline mutex& getMutex() noexcept
@@ -77,7 +139,7 @@ namespace Kiwi
     public:
         
         //! Add an object to the factory.
-        /** This function adds a new object to the factory. If the name of the object already exists, the function doesn't do anything otherwise the object is added to the factory.
+        /** This function adds a new object to the factory. If the name of the object already exists, the function doesn't do anything otherwise the object is added to the factory. The function only creates a prototype of the object to retrieve its default name if no name is given and the class doesn't define a static method getClassName that returns it.
          @name  An alias name of the object or nothing if you want yo use the default object name.
          */
         template <class T> static void add(sTag name = Tags::_empty)
@@ -87,19 +149,23 @@ namespace Kiwi
             static_assert(!is_abstract<T>::value, "The class must not be abstract.");
             static_assert(is_constructible<T, Infos const&>::value, "The class must be constructible with Infos.");
             
-            sObject object = make_shared<T>(Infos());
-            if(object)
+            if(name == Tags::_empty)
+            {
+                name = getDefaultName<T>(integral_constant<bool, HasClassName<T>::value>());
+            }
+            if(name)
             {
                 lock_guard<mutex> guard(getMutex());
-                map<sTag, sCreator>& creators(getCreators());
-                if(name == Tags::_empty) {name = object->getName();}
-                if(creators.find(name) != creators.end())
+                const Creators* creators = getCreators();
+                if(creators->find(name) != creators->end())
                 {
                     Console::error("The object " + name->getName() + " already exist !");
                 }
                 else
                 {
-                    creators[name] = make_shared<CreatorTyped<T>>();
+                    unique_ptr<Creators> updated(new Creators(*creators));
+                    (*updated)[name] = make_shared<CreatorTyped<T>>();
+                    publish(move(updated));
                 }
             }
             else
@@ -109,7 +175,7 @@ namespace Kiwi
         }
         
         //! Create an object.
-        /** This function creates an object.
+        /** This function creates an object. The function reads the current registry without locking the factory so the objects can be created concurrently.
          @param name The name of the object.
          @param node The detail to initialize the object.
          @return An object.
@@ -123,6 +189,13 @@ namespace Kiwi
          */
         static bool has(const sTag name);
         
+        //! Retrieves if an object is a dsp object.
+        /** This function retrieves if the class of an object inherits from the dsp node without creating the object.
+         @param name The name of the object.
+         @return true if the object exist and is a dsp object, otherwise false.
+         */
+        static bool isDsp(const sTag name);
+        
         //! Removes an object from the factory.
         /** This function remoes an object from the factory.
          @param name The name of the object.
@@ -36,7 +36,8 @@ namespace Kiwi
     Instance::Instance(sGuiDeviceManager guiDevice, sDspDeviceManager dspDevice, sTag name) noexcept :
     GuiContext(guiDevice),
     DspContext(dspDevice),
-    m_name(name)
+    m_name(name),
+    m_patchers_snapshot(make_shared<const vector<sPatcher>>())
     {
 		;
     }
@@ -59,15 +60,16 @@ namespace Kiwi
         return createPatcher(dico);
     }
 
-    sPatcher Instance::createPatcher(Dico& dico)
+    sPatcher Instance::createPatcher(Dico& dico, const bool lazy)
     {
         sPatcher patcher;
         bool state(false);
         {
-            patcher = Patcher::create(getShared(), dico);
+            patcher = Patcher::create(getShared(), dico, lazy);
             lock_guard<mutex> guard(m_patchers_mutex);
             if(patcher && m_patchers.insert(patcher).second)
             {
+                atomic_store(&m_patchers_snapshot, shared_ptr<const vector<sPatcher>>(make_shared<const vector<sPatcher>>(m_patchers.begin(), m_patchers.end())));
                 DspContext::add(patcher);
                 state = true;
             }
@@ -85,6 +87,10 @@ namespace Kiwi
         {
             lock_guard<mutex> guard(m_patchers_mutex);
             success = m_patchers.erase(patcher);
+            if(success)
+            {
+                atomic_store(&m_patchers_snapshot, shared_ptr<const vector<sPatcher>>(make_shared<const vector<sPatcher>>(m_patchers.begin(), m_patchers.end())));
+            }
         }
         if(success)
         {
@@ -93,6 +99,65 @@ namespace Kiwi
         }
     }
     
+    void Instance::tick() noexcept
+    {
+        const shared_ptr<const vector<sPatcher>> patchers = atomic_load(&m_patchers_snapshot);
+        m_executor.parallel(ulong(patchers->size()), [&patchers](ulong index)
+        {
+            (*patchers)[(vector<sPatcher>::size_type)index]->DspChain::tick();
+        });
+    }
+    
+    //! @internal Retrieve the objects of the patchers that have been loaded, a lazy patcher has no records.
+    static vector<sObject> getLoadedObjects(vector<sPatcher> const& patchers)
+    {
+        vector<sObject> all;
+        for(auto patcher : patchers)
+        {
+            if(patcher->isLoaded())
+            {
+                const Patcher::scObjects snapshot = patcher->getObjectsSnapshot();
+                all.insert(all.end(), snapshot->begin(), snapshot->end());
+            }
+        }
+        return all;
+    }
+    
+    void Instance::getProfiles(vector<Profiler::ObjectProfile>& objects, vector<Profiler::OutletProfile>& outlets)
+    {
+        Profiler::collect(getLoadedObjects(getPatchers()), objects, outlets);
+    }
+    
+    void Instance::resetProfiles()
+    {
+        Profiler::reset(getLoadedObjects(getPatchers()));
+    }
+    
+    void Instance::postProfiles(const ulong count)
+    {
+        vector<Profiler::ObjectProfile> objects;
+        vector<Profiler::OutletProfile> outlets;
+        getProfiles(objects, outlets);
+        sort(objects.begin(), objects.end(), [](Profiler::ObjectProfile const& a, Profiler::ObjectProfile const& b)
+        {
+            return a.time > b.time;
+        });
+        sort(outlets.begin(), outlets.end(), [](Profiler::OutletProfile const& a, Profiler::OutletProfile const& b)
+        {
+            return a.messages > b.messages;
+        });
+        
+        Console::post("Profiler : " + to_string(objects.size()) + " objects and " + to_string(outlets.size()) + " outlets.");
+        for(vector<Profiler::ObjectProfile>::size_type i = 0; i < objects.size() && i < count; i++)
+        {
+            Console::post(objects[i].object, to_string(objects[i].messages) + " messages received in " + to_string(objects[i].time) + " ms, " + to_string(objects[i].maximum) + " ms at most.");
+        }
+        for(vector<Profiler::OutletProfile>::size_type i = 0; i < outlets.size() && i < count; i++)
+        {
+            Console::post(outlets[i].object, "outlet " + to_string(outlets[i].index) + " : " + to_string(outlets[i].messages) + " messages sent to " + to_string(outlets[i].connections) + " connections, " + to_string(outlets[i].maximum) + " at most.");
+        }
+    }
+    
     vector<sPatcher> Instance::getPatchers()
     {
         lock_guard<mutex> guard(m_patchers_mutex);
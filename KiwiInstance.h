@@ -25,6 +25,9 @@
 #define __DEF_KIWI_INSTANCE__
 
 #include "KiwiPatch.h"
+#include "KiwiScheduler.h"
+#include "KiwiExecutor.h"
+#include "KiwiProfiler.h"
 
 // TODO :
 // - See how to set the input and output vector for DSP.
@@ -61,7 +64,10 @@ namespace Kiwi
         const sTag              m_name;
         set<sPatcher>           m_patchers;
         mutex                   m_patchers_mutex;
+        shared_ptr<const vector<sPatcher>> m_patchers_snapshot;
         ListenerSet<Listener>   m_listeners;
+        Executor                m_executor;
+        Scheduler               m_scheduler;
         
     public:
         
@@ -125,10 +131,11 @@ namespace Kiwi
         //! Create a patcher with a dict.
         /** The function creates a patcher with a dict.
          @param dico The dico that defines of the patcher.
+         @param lazy If the creation of the objects should be delayed until the patcher is used.
          @return The patcher.
-         @see removePatcher, getPatchers
+         @see removePatcher, getPatchers, Patcher::create
          */
-        sPatcher createPatcher(Dico& dico);
+        sPatcher createPatcher(Dico& dico, const bool lazy = false);
         
         //! Close a patcher.
         /** The function closes patcher.
@@ -144,6 +151,55 @@ namespace Kiwi
          */
         vector<sPatcher> getPatchers();
         
+        //! Process the dsp chains of the patchers.
+        /** The function ticks the dsp chains of the patchers in parallel with the executor of the instance and returns when all the chains have been processed. The patchers don't share their chains so they are independent, the device callback can call this function instead of processing the chains one after the other.
+         @see Executor
+         */
+        void tick() noexcept;
+        
+        //! Retrieve the executor of the instance.
+        /** The function retrieves the executor that runs the tasks of the instance on the worker threads.
+         @return The executor.
+         */
+        inline Executor& getExecutor() noexcept
+        {
+            return m_executor;
+        }
+        
+        //! Retrieve the profiles of the objects and the outlets of the patchers.
+        /** The function retrieves the records of the profiler for the objects and the outlets of the patchers of the instance.
+         @param objects The profiles of the objects.
+         @param outlets The profiles of the outlets.
+         @see Profiler
+         */
+        void getProfiles(vector<Profiler::ObjectProfile>& objects, vector<Profiler::OutletProfile>& outlets);
+        
+        //! Reset the profiles of the objects and the outlets of the patchers.
+        /** The function resets the records of the profiler for the objects and the outlets of the patchers of the instance.
+         @see Profiler
+         */
+        void resetProfiles();
+        
+        //! Post the profiles of the objects and the outlets in the console.
+        /** The function posts the objects that spent the most time in their receive methods and the outlets that sent the most messages.
+         @param count The maximum number of objects and outlets to post.
+         @see Profiler
+         */
+        void postProfiles(const ulong count = 10);
+        
+        //! Defer the sending of a message.
+        /** The function posts a message to the scheduler of the instance that sends it via an outlet of the object from the scheduler thread. The function never locks.
+         @param object The object.
+         @param index  The index of the outlet.
+         @param atoms  The atoms.
+         @return True if the message has been posted, false if the scheduler is full.
+         @see Object::defer
+         */
+        inline bool defer(scObject object, const ulong index, Vector const& atoms) noexcept
+        {
+            return m_scheduler.post(object, index, atoms);
+        }
+        
         //! Add an instance listener in the binding list of the instance.
         /** The function adds an instance listener in the binding list of the instance. 
 		 If the instance listener is already in the binding list, the function doesn't do anything.
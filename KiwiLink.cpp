@@ -38,7 +38,8 @@ namespace Kiwi
     m_object_to(to),
     m_index_outlet(outlet),
     m_index_intlet(inlet),
-    m_type(type)
+    m_type(type),
+    m_attached(true)
     {
         ;
     }
@@ -47,17 +48,17 @@ namespace Kiwi
     {
         sObject     from    = getObjectFrom();
         sObject     to      = getObjectTo();
-        if(from && to)
+        if(m_attached && from && to)
         {
             Object::sOutlet outlet  = from->getOutlet(m_index_outlet);
             if(outlet)
             {
-                outlet->erase(to, m_index_outlet);
+                outlet->erase(to, m_index_intlet);
             }
             Object::sInlet inlet    = to->getInlet(m_index_intlet);
             if(inlet)
             {
-                inlet->erase(from, m_index_intlet);
+                inlet->erase(from, m_index_outlet);
             }
         }
     }
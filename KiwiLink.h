@@ -38,13 +38,28 @@ namespace Kiwi
      */
     class Link
     {
+        friend class Patcher;
     private:
         const wPatcher          m_patcher;
         const wObject           m_object_from;
         const wObject           m_object_to;
-        const ulong             m_index_outlet;
-        const ulong             m_index_intlet;
+        atomic_ulong            m_index_outlet;
+        atomic_ulong            m_index_intlet;
         const Object::Io::Type  m_type;
+        atomic_bool             m_attached;
+        
+        //! @internal Change the indices of the link when an iolet before it has been removed.
+        inline void setIndices(const ulong outlet, const ulong inlet) noexcept
+        {
+            m_index_outlet = outlet;
+            m_index_intlet = inlet;
+        }
+        
+        //! @internal Prevent the link from erasing the connection when it is deleted.
+        inline void detach() noexcept
+        {
+            m_attached = false;
+        }
     public:
         
         //! The constructor.
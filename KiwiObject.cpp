@@ -25,6 +25,7 @@
 #include "KiwiPatch.h"
 #include "KiwiInstance.h"
 #include "KiwiConsole.h"
+#include "KiwiProfiler.h"
 
 namespace Kiwi
 {
@@ -34,10 +35,10 @@ namespace Kiwi
     
     const Object::Connection Object::Iolet::getConnection(const ulong index) const noexcept
     {
-        lock_guard<mutex> guard(m_mutex);
-        if(index < (ulong)m_connections.size())
+        const scReceivers receivers = getReceivers();
+        if(index < (ulong)receivers->objects.size())
         {
-            return m_connections[(vector<Connection>::size_type)index];
+            return {receivers->references[(vector<wObject>::size_type)index], receivers->indices[(vector<ulong>::size_type)index]};
         }
         else
         {
@@ -47,10 +48,10 @@ namespace Kiwi
     
     Object::Connection Object::Iolet::getConnection(const ulong index) noexcept
     {
-        lock_guard<mutex> guard(m_mutex);
-        if(index < (ulong)m_connections.size())
+        const scReceivers receivers = getReceivers();
+        if(index < (ulong)receivers->objects.size())
         {
-            return m_connections[(vector<Connection>::size_type)index];
+            return {receivers->references[(vector<wObject>::size_type)index], receivers->indices[(vector<ulong>::size_type)index]};
         }
         else
         {
@@ -60,10 +61,10 @@ namespace Kiwi
     
     scObject Object::Iolet::getObject(const ulong index) const noexcept
     {
-        lock_guard<mutex> guard(m_mutex);
-        if(index < (ulong)m_connections.size())
+        const scReceivers receivers = getReceivers();
+        if(index < (ulong)receivers->objects.size())
         {
-            return m_connections[(vector<Connection>::size_type)index].object.lock();
+            return receivers->references[(vector<wObject>::size_type)index].lock();
         }
         else
         {
@@ -73,10 +74,10 @@ namespace Kiwi
     
     sObject Object::Iolet::getObject(const ulong index) noexcept
     {
-        lock_guard<mutex> guard(m_mutex);
-        if(index < (ulong)m_connections.size())
+        const scReceivers receivers = getReceivers();
+        if(index < (ulong)receivers->objects.size())
         {
-            return m_connections[(vector<Connection>::size_type)index].object.lock();
+            return receivers->references[(vector<wObject>::size_type)index].lock();
         }
         else
         {
@@ -87,10 +88,10 @@ namespace Kiwi
 
     ulong Object::Iolet::getIndex(const ulong index) const noexcept
     {
-        lock_guard<mutex> guard(m_mutex);
-        if(index < (ulong)m_connections.size())
+        const scReceivers receivers = getReceivers();
+        if(index < (ulong)receivers->objects.size())
         {
-            return m_connections[(vector<Connection>::size_type)index].index;
+            return receivers->indices[(vector<ulong>::size_type)index];
         }
         else
         {
@@ -103,48 +104,83 @@ namespace Kiwi
         if(object)
         {
             lock_guard<mutex> guard(m_mutex);
-            for(vector<Connection>::size_type i = 0; i < m_connections.size(); i++)
+            return m_keys.count({object.get(), index}) != 0;
+        }
+        return false;
+    }
+    
+    bool Object::Iolet::append(sObject object, ulong index) noexcept
+    {
+        if(object)
+        {
+            lock_guard<mutex> guard(m_mutex);
+            if(!m_keys.insert({object.get(), index}).second)
             {
-                sObject cobject = m_connections[i].object.lock();
-                if(cobject && object == cobject && m_connections[i].index == index)
-                {
-                    return true;
-                }
+                return false;
+            }
+            const scReceivers receivers = getReceivers();
+            shared_ptr<Receivers> updated = make_shared<Receivers>(*receivers);
+            updated->objects.push_back(object.get());
+            updated->indices.push_back(index);
+            updated->references.push_back(object);
+            if(m_owner)
+            {
+                updated->owners.push_back(object);
             }
+            publish(updated);
+            return true;
         }
         return false;
     }
     
-    bool Object::Iolet::append(sObject object, ulong index) noexcept
+    bool Object::Iolet::erase(sObject object, ulong index) noexcept
     {
         if(object)
         {
             lock_guard<mutex> guard(m_mutex);
-            for(vector<Connection>::size_type i = 0; i < m_connections.size(); i++)
+            if(!m_keys.erase({object.get(), index}))
+            {
+                return false;
+            }
+            const scReceivers receivers = getReceivers();
+            for(vector<Object*>::size_type i = 0; i < receivers->objects.size(); i++)
             {
-                sObject cobject = m_connections[i].object.lock();
-                if(cobject && object == cobject && m_connections[i].index == index)
+                if(receivers->objects[i] == object.get() && receivers->indices[i] == index)
                 {
-                    return false;
+                    shared_ptr<Receivers> updated = make_shared<Receivers>(*receivers);
+                    updated->objects.erase(updated->objects.begin() + i);
+                    updated->indices.erase(updated->indices.begin() + i);
+                    updated->references.erase(updated->references.begin() + i);
+                    if(m_owner)
+                    {
+                        updated->owners.erase(updated->owners.begin() + i);
+                    }
+                    publish(updated);
+                    return true;
                 }
             }
-            m_connections.push_back({object, index});
-            return true;
         }
         return false;
     }
     
-    bool Object::Iolet::erase(sObject object, ulong index) noexcept
+    bool Object::Iolet::renumber(sObject object, ulong index, ulong newindex) noexcept
     {
         if(object)
         {
             lock_guard<mutex> guard(m_mutex);
-            for(vector<Connection>::size_type i = 0; i < m_connections.size(); i++)
+            if(m_keys.count({object.get(), newindex}) || !m_keys.erase({object.get(), index}))
+            {
+                return false;
+            }
+            m_keys.insert({object.get(), newindex});
+            const scReceivers receivers = getReceivers();
+            for(vector<Object*>::size_type i = 0; i < receivers->objects.size(); i++)
             {
-                sObject cobject = m_connections[i].object.lock();
-                if(cobject && object == cobject && m_connections[i].index == index)
+                if(receivers->objects[i] == object.get() && receivers->indices[i] == index)
                 {
-                    m_connections.erase(m_connections.begin() + i);
+                    shared_ptr<Receivers> updated = make_shared<Receivers>(*receivers);
+                    updated->indices[i] = newindex;
+                    publish(updated);
                     return true;
                 }
             }
@@ -152,12 +188,54 @@ namespace Kiwi
         return false;
     }
     
+    void Object::Iolet::publish(scReceivers receivers) noexcept
+    {
+        atomic_store(&m_receivers, receivers);
+    }
+    
     Object::Outlet::Outlet(Io::Type type, string const& description) noexcept :
-    Iolet(type, Io::Polarity::Hot, description)
+    Iolet(type, Io::Polarity::Hot, description, true),
+    m_table(getReceivers().get()),
+    m_dirty(false),
+    m_readers(0)
     {
         ;
     }
     
+    void Object::Outlet::publish(scReceivers receivers) noexcept
+    {
+        // The previous snapshot can be read by a dispatch in progress, it is retired and released when there is no dispatch.
+        m_retired.push_back(getReceivers());
+        Iolet::publish(receivers);
+        m_table = receivers.get();
+        m_dirty = true;
+        if(m_readers == 0)
+        {
+            m_retired.clear();
+            m_dirty = false;
+        }
+    }
+    
+    void Object::Outlet::release() const noexcept
+    {
+        // The retired snapshots own the receivers, if they were only released by the next publish a loop of links would keep its objects alive.
+        vector<scReceivers> retired;
+        while(m_dirty && m_readers == 0)
+        {
+            unique_lock<mutex> lock(m_mutex, try_to_lock);
+            if(lock.owns_lock())
+            {
+                if(m_readers == 0)
+                {
+                    retired.swap(m_retired);
+                    m_dirty = false;
+                }
+                break;
+            }
+            this_thread::yield();
+        }
+    }
+    
     Object::Outlet::~Outlet()
     {
         ;
@@ -165,28 +243,185 @@ namespace Kiwi
     
     void Object::Outlet::send(Vector const& atoms) const noexcept
     {
-        lock_guard<mutex> guard(m_mutex);
-        for(vector<Connection>::size_type i = 0; i < m_connections.size(); i++)
+        if(isIterative() || getStack().running)
+        {
+            sendIterative(atoms);
+        }
+        else
+        {
+            sendRecursive(&Object::receive, atoms);
+        }
+    }
+    
+    void Object::Outlet::sendBang() const noexcept
+    {
+        if(isIterative() || getStack().running)
+        {
+            sendIterative(Vector());
+        }
+        else
+        {
+            sendRecursive(&Object::receiveBang);
+        }
+    }
+    
+    void Object::Outlet::sendLong(const long value) const noexcept
+    {
+        if(isIterative() || getStack().running)
+        {
+            sendIterative(Atom(value));
+        }
+        else
+        {
+            sendRecursive(&Object::receiveLong, value);
+        }
+    }
+    
+    void Object::Outlet::sendDouble(const double value) const noexcept
+    {
+        if(isIterative() || getStack().running)
         {
-            sObject receiver = m_connections[i].object.lock();
-            ulong inlet      = m_connections[i].index;
-            if(receiver)
+            sendIterative(Atom(value));
+        }
+        else
+        {
+            sendRecursive(&Object::receiveDouble, value);
+        }
+    }
+    
+    void Object::Outlet::sendTag(sTag tag) const noexcept
+    {
+        if(isIterative() || getStack().running)
+        {
+            sendIterative(Atom(tag));
+        }
+        else
+        {
+            sendRecursive(&Object::receiveTag, tag);
+        }
+    }
+    
+    template<class ...Parameters, class ...Arguments>
+    void Object::Outlet::sendRecursive(void (Object::*method)(const ulong, Parameters...), Arguments&&... arguments) const noexcept
+    {
+        // The snapshot can't be released while the dispatch is counted.
+        m_readers++;
+        const Receivers* receivers = m_table;
+        const bool profile = Profiler::isEnabled();
+        if(profile)
+        {
+            Profiler::send(this, ulong(receivers->objects.size()));
+        }
+        for(vector<Object*>::size_type i = 0; i < receivers->objects.size(); i++)
+        {
+            Object* receiver = receivers->objects[i];
+            ulong inlet      = receivers->indices[i];
+            if(++receiver->m_stack_count <= 256)
             {
-                if(++receiver->m_stack_count < 256)
+                if(profile)
                 {
-                    receiver->receive(inlet, atoms);
+                    const Profiler::Clock::time_point start = Profiler::Clock::now();
+                    (receiver->*method)(inlet, arguments...);
+                    Profiler::receive(receiver, Profiler::Clock::now() - start);
                 }
-                else if(receiver->m_stack_count  == 256)
+                else
                 {
-                    receiver->receive(inlet, atoms);
+                    (receiver->*method)(inlet, arguments...);
+                }
+            }
+            else
+            {
+                Console::error(receiver->getShared(), "Stack overflow");
+            }
+            receiver->m_stack_count--;
+        }
+        if(--m_readers == 0 && m_dirty)
+        {
+            release();
+        }
+    }
+    
+    Object::Outlet::Task Object::Outlet::createTask(Stack& stack, scReceivers receivers, const ulong depth, Vector const& atoms)
+    {
+        if(stack.spares.empty())
+        {
+            return {receivers, 0, depth, atoms};
+        }
+        Task task = {receivers, 0, depth, move(stack.spares.back())};
+        stack.spares.pop_back();
+        task.atoms.assign(atoms.begin(), atoms.end());
+        return task;
+    }
+    
+    void Object::Outlet::sendIterative(Atom&& atom) const noexcept
+    {
+        Vector& atoms = Object::acquireVector();
+        atoms.push_back(move(atom));
+        sendIterative(atoms);
+        Object::releaseVector();
+    }
+    
+    void Object::Outlet::sendIterative(Vector const& atoms) const noexcept
+    {
+        Stack& stack = getStack();
+        if(stack.running)
+        {
+            // The message is sent during the reception of another one, it will be dispatched when the receiver returns.
+            stack.pending.push_back(createTask(stack, getReceivers(), stack.depth + 1, atoms));
+            if(Profiler::isEnabled())
+            {
+                Profiler::send(this, ulong(stack.pending.back().receivers->objects.size()));
+            }
+            return;
+        }
+        
+        stack.running = true;
+        stack.tasks.push_back(createTask(stack, getReceivers(), 0, atoms));
+        if(Profiler::isEnabled())
+        {
+            Profiler::send(this, ulong(stack.tasks.back().receivers->objects.size()));
+        }
+        while(!stack.tasks.empty())
+        {
+            Task& task = stack.tasks.back();
+            if(task.next < task.receivers->objects.size())
+            {
+                const vector<Object*>::size_type i = task.next++;
+                if(task.depth < maximumDepth)
+                {
+                    stack.depth = task.depth;
+                    if(Profiler::isEnabled())
+                    {
+                        const Profiler::Clock::time_point start = Profiler::Clock::now();
+                        task.receivers->objects[i]->receive(task.receivers->indices[i], task.atoms);
+                        Profiler::receive(task.receivers->objects[i], Profiler::Clock::now() - start);
+                    }
+                    else
+                    {
+                        task.receivers->objects[i]->receive(task.receivers->indices[i], task.atoms);
+                    }
                 }
                 else
                 {
-                    Console::error(receiver, "Stack overflow");
+                    Console::error(task.receivers->owners[i], "Stack overflow");
+                }
+                
+                // The first message sent must be dispatched first so the pending messages are stacked in the reverse order.
+                for(auto it = stack.pending.rbegin(); it != stack.pending.rend(); ++it)
+                {
+                    stack.tasks.push_back(move(*it));
                 }
-                receiver->m_stack_count--;
+                stack.pending.clear();
+            }
+            else
+            {
+                task.atoms.clear();
+                stack.spares.push_back(move(task.atoms));
+                stack.tasks.pop_back();
             }
         }
+        stack.depth   = 0;
+        stack.running = false;
     }
     
     Object::Inlet::Inlet(Io::Type type, Io::Polarity polarity, string const& description) noexcept :
@@ -211,8 +446,15 @@ namespace Kiwi
     m_name(name),
     m_text(detail.text),
     m_id(detail.lid),
+    m_dsp_inlets(1, 0),
+    m_dsp_outlets(1, 0),
+    m_outlets_size(0),
     m_stack_count(0)
     {
+        for(ulong i = 0; i < inlineOutlets; i++)
+        {
+            m_outlets_table[i] = nullptr;
+        }
         createAttr(Tags::position,              "Position",                 "Appearance", Point(0., 0.));
         createAttr(Tags::size,                  "Size",                     "Appearance", Size(10., 10.));
         createAttr(Tags::presentation_position, "Presentation Position",    "Appearance", Point(0., 0.));
@@ -225,6 +467,8 @@ namespace Kiwi
     Object::~Object() noexcept
     {
         lock_guard<mutex> guard(m_mutex);
+        m_outlets_size = 0;
+        m_outlets_retired.clear();
         m_outlets.clear();
         m_inlets.clear();
     }
@@ -237,69 +481,273 @@ namespace Kiwi
         dico[Tags::text]       = getText();
         dico[Tags::id]         = (long)getId();
         dico[Tags::ninlets]    = (long)getNumberOfInlets();
-        dico[Tags::noutlets]   = (long)getNumberOfInlets();
+        dico[Tags::noutlets]   = (long)getNumberOfOutlets();
+    }
+    
+    void Object::publishOutlets(const ulong from) noexcept
+    {
+        const ulong size = ulong(m_outlets.size()) < inlineOutlets ? ulong(m_outlets.size()) : inlineOutlets;
+        if(from < m_outlets_size.load(memory_order_relaxed))
+        {
+            // The senders of the indices after the change take the locked path while the table is written.
+            m_outlets_size.store(from, memory_order_release);
+        }
+        for(ulong i = from; i < size; i++)
+        {
+            m_outlets_table[i].store(m_outlets[vector<sOutlet>::size_type(i)].get(), memory_order_relaxed);
+        }
+        m_outlets_size.store(size, memory_order_release);
+    }
+    
+    Object::Outlet* Object::findOutlet(const ulong index, sOutlet& holder) const noexcept
+    {
+        if(index < m_outlets_size.load(memory_order_acquire))
+        {
+            return m_outlets_table[index].load(memory_order_relaxed);
+        }
+        else
+        {
+            // The outlets after the table and the ones of the table while it's written.
+            lock_guard<mutex> guard(m_mutex);
+            if(vector<sOutlet>::size_type(index) < m_outlets.size())
+            {
+                holder = m_outlets[vector<sOutlet>::size_type(index)];
+            }
+        }
+        return holder.get();
     }
     
     void Object::send(const ulong index, Vector const& atoms) const noexcept
     {
-        lock_guard<mutex> guard(m_mutex);
-        if(vector<sOutlet>::size_type(index) < m_outlets.size())
+        sOutlet holder;
+        Outlet* outlet = findOutlet(index, holder);
+        if(outlet)
+        {
+            outlet->send(atoms);
+        }
+    }
+
+    //! @internal The vectors of atoms borrowed by the sending methods of a thread.
+    struct VectorPool
+    {
+        vector<unique_ptr<Vector>>              vectors;
+        vector<unique_ptr<Vector>>::size_type   size;
+    };
+    
+    static VectorPool& getVectorPool() noexcept
+    {
+        static thread_local VectorPool _pool = {{}, 0};
+        return _pool;
+    }
+    
+    void Object::receiveBang(const ulong index)
+    {
+        receive(index, Vector());
+    }
+    
+    void Object::receiveLong(const ulong index, const long value)
+    {
+        Vector& atoms = acquireVector();
+        atoms.push_back(Atom(value));
+        receive(index, atoms);
+        releaseVector();
+    }
+    
+    void Object::receiveDouble(const ulong index, const double value)
+    {
+        Vector& atoms = acquireVector();
+        atoms.push_back(Atom(value));
+        receive(index, atoms);
+        releaseVector();
+    }
+    
+    void Object::receiveTag(const ulong index, sTag tag)
+    {
+        Vector& atoms = acquireVector();
+        atoms.push_back(Atom(tag));
+        receive(index, atoms);
+        releaseVector();
+    }
+    
+    Vector& Object::acquireVector() noexcept
+    {
+        VectorPool& pool = getVectorPool();
+        if(pool.size == pool.vectors.size())
+        {
+            pool.vectors.push_back(unique_ptr<Vector>(new Vector()));
+        }
+        return *pool.vectors[pool.size++];
+    }
+    
+    void Object::releaseVector() noexcept
+    {
+        VectorPool& pool = getVectorPool();
+        pool.vectors[--pool.size]->clear();
+    }
+    
+    void Object::sendBang(const ulong index) const noexcept
+    {
+        sOutlet holder;
+        Outlet* outlet = findOutlet(index, holder);
+        if(outlet)
+        {
+            outlet->sendBang();
+        }
+    }
+    
+    void Object::sendLong(const ulong index, const long value) const noexcept
+    {
+        sOutlet holder;
+        Outlet* outlet = findOutlet(index, holder);
+        if(outlet)
+        {
+            outlet->sendLong(value);
+        }
+    }
+    
+    void Object::sendDouble(const ulong index, const double value) const noexcept
+    {
+        sOutlet holder;
+        Outlet* outlet = findOutlet(index, holder);
+        if(outlet)
         {
-            m_outlets[vector<sOutlet>::size_type(index)]->send(atoms);
+            outlet->sendDouble(value);
         }
     }
+    
+    void Object::sendTag(const ulong index, sTag tag) const noexcept
+    {
+        sOutlet holder;
+        Outlet* outlet = findOutlet(index, holder);
+        if(outlet)
+        {
+            outlet->sendTag(tag);
+        }
+    }
+    
+    bool Object::defer(const ulong index, Vector const& atoms) const noexcept
+    {
+        sInstance instance = getInstance();
+        if(instance)
+        {
+            return instance->defer(getShared(), index, atoms);
+        }
+        return false;
+    }
 
     void Object::addInlet(Io::Type type, Io::Polarity polarity, string const& description)
     {
+        sPatcher patcher = getPatcher();
         lock_guard<mutex> guard(m_mutex);
-        sInlet inlet = make_shared<Inlet>(type, polarity, description);
+        sInlet inlet = Arena::create<Inlet>(patcher ? patcher->getArena() : nullptr, type, polarity, description);
         if(inlet)
         {
             m_inlets.push_back(inlet);
             if(inlet->getType() & Io::Type::Signal)
             {
+                m_dsp_inlets.push_back(m_dsp_inlets.back() + 1);
                 DspNode* node = dynamic_cast<DspNode *>(this);
                 if(node)
                 {
-                    node->setNumberOfInlets(ulong(m_inlets.size()));
+                    node->setNumberOfInlets(m_dsp_inlets.back());
                 }
             }
+            else
+            {
+                m_dsp_inlets.push_back(m_dsp_inlets.back());
+            }
         }
     }
     
     void Object::addOutlet(Io::Type type, string const& description)
     {
+        sPatcher patcher = getPatcher();
         lock_guard<mutex> guard(m_mutex);
-        sOutlet outlet = make_shared<Outlet>(type, description);
+        sOutlet outlet = Arena::create<Outlet>(patcher ? patcher->getArena() : nullptr, type, description);
         if(outlet)
         {
             m_outlets.push_back(outlet);
+            publishOutlets(ulong(m_outlets.size() - 1));
             if(outlet->getType() & Io::Type::Signal)
             {
+                m_dsp_outlets.push_back(m_dsp_outlets.back() + 1);
                 DspNode* node = dynamic_cast<DspNode *>(this);
                 if(node)
                 {
-                    node->setNumberOfOutlets(ulong(m_outlets.size()));
+                    node->setNumberOfOutlets(m_dsp_outlets.back());
                 }
             }
+            else
+            {
+                m_dsp_outlets.push_back(m_dsp_outlets.back());
+            }
         }
     }
     
     void Object::removeInlet(const ulong index)
     {
+        // The patcher can't be called with the mutex locked because the links lock the objects.
+        sPatcher patcher = getPatcher();
+        if(patcher && index < getNumberOfInlets())
+        {
+            patcher->detachIolet(getShared(), index, true);
+        }
+        
         lock_guard<mutex> guard(m_mutex);
         if(index < ulong(m_inlets.size()))
         {
-            
+            const vector<sInlet>::size_type pos = vector<sInlet>::size_type(index);
+            const bool signal = m_inlets[pos]->getType() & Io::Type::Signal;
+            m_inlets.erase(m_inlets.begin() + pos);
+            m_dsp_inlets.erase(m_dsp_inlets.begin() + pos + 1);
+            if(signal)
+            {
+                for(auto it = m_dsp_inlets.begin() + pos + 1; it != m_dsp_inlets.end(); ++it)
+                {
+                    (*it)--;
+                }
+                DspNode* node = dynamic_cast<DspNode *>(this);
+                if(node)
+                {
+                    node->setNumberOfInlets(m_dsp_inlets.back());
+                }
+            }
         }
     }
     
     void Object::removeOutlet(const ulong index)
     {
+        // The patcher can't be called with the mutex locked because the links lock the objects.
+        sPatcher patcher = getPatcher();
+        if(patcher && index < getNumberOfOutlets())
+        {
+            patcher->detachIolet(getShared(), index, false);
+        }
+        
         lock_guard<mutex> guard(m_mutex);
         if(index < ulong(m_outlets.size()))
         {
-            
+            const vector<sOutlet>::size_type pos = vector<sOutlet>::size_type(index);
+            const bool signal = m_outlets[pos]->getType() & Io::Type::Signal;
+            if(index < inlineOutlets)
+            {
+                m_outlets_retired.push_back(m_outlets[pos]);
+            }
+            m_outlets.erase(m_outlets.begin() + pos);
+            publishOutlets(index);
+            m_dsp_outlets.erase(m_dsp_outlets.begin() + pos + 1);
+            if(signal)
+            {
+                for(auto it = m_dsp_outlets.begin() + pos + 1; it != m_dsp_outlets.end(); ++it)
+                {
+                    (*it)--;
+                }
+                DspNode* node = dynamic_cast<DspNode *>(this);
+                if(node)
+                {
+                    node->setNumberOfOutlets(m_dsp_outlets.back());
+                }
+            }
         }
     }
     
@@ -349,19 +797,12 @@ namespace Kiwi
     
     ulong Object::getDspInletIndex(ulong index) const throw(Error&)
     {
+        lock_guard<mutex> guard(m_mutex);
         if(index < m_inlets.size())
         {
             if(m_inlets[index]->getType() & Object::Io::Signal)
             {
-                ulong dspindex = 0;
-                for(ulong i = index; i; i--)
-                {
-                    if(m_inlets[i-1]->getType() & Object::Io::Signal)
-                    {
-                        dspindex++;
-                    }
-                }
-                return dspindex;
+                return m_dsp_inlets[(vector<ulong>::size_type)index];
             }
             else
             {
@@ -420,19 +861,12 @@ namespace Kiwi
     
     ulong Object::getDspOutletIndex(ulong index) const throw(Error&)
     {
+        lock_guard<mutex> guard(m_mutex);
         if(index < m_outlets.size())
         {
             if(m_outlets[index]->getType() & Object::Io::Signal)
             {
-                ulong dspindex = 0;
-                for(ulong i = index; i; i--)
-                {
-                    if(m_outlets[i-1]->getType() & Object::Io::Signal)
-                    {
-                        dspindex++;
-                    }
-                }
-                return dspindex;
+                return m_dsp_outlets[(vector<ulong>::size_type)index];
             }
             else
             {
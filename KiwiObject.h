@@ -27,6 +27,7 @@
 #include "../KiwiDsp/KiwiDsp.h"
 #include "../KiwiGui/KiwiGui.h"
 #include "KiwiConsole.h"
+#include "KiwiArena.h"
 
 namespace Kiwi
 {
@@ -124,6 +125,8 @@ namespace Kiwi
     {
     public:
         friend class Patcher;
+        friend class Scheduler;
+        friend class Profiler;
         
         struct Io
         {
@@ -164,6 +167,18 @@ namespace Kiwi
         typedef weak_ptr<const Controller>      wcController;
     
     private:
+        //! @internal The records of the profiler, a number of records, their sum and their maximum.
+        /** The records live with the object or the outlet they belong to, so they are freed with it and they are updated with relaxed atomic operations without lock.
+         */
+        struct Records
+        {
+            atomic_ulong    count;
+            atomic_ullong   total;
+            atomic_ullong   maximum;
+            
+            Records() noexcept : count(0), total(0), maximum(0) {}
+        };
+        
         struct Connection
         {
             wObject object;
@@ -176,11 +191,38 @@ namespace Kiwi
         const string            m_text;
         const ulong             m_id;
         
+        //! @internal The number of outlets that the sending methods reach without lock.
+        static const ulong      inlineOutlets = 8;
+        
         vector<sOutlet>			m_outlets;
         vector<sInlet>			m_inlets;
+        vector<ulong>           m_dsp_inlets;
+        vector<ulong>           m_dsp_outlets;
+        atomic<Outlet*>         m_outlets_table[inlineOutlets];
+        atomic_ulong            m_outlets_size;
+        vector<sOutlet>         m_outlets_retired;
         atomic_ullong			m_stack_count;
+        mutable Records         m_records;
         mutable mutex			m_mutex;
         vector<exception_ptr>   m_errors;
+        
+        //! @internal Copy the first outlets in the table of the sending methods from an index.
+        /** The function must be called with the mutex locked after the outlets changed. The outlets removed from the table are retired and kept until the object is deleted because a sending method can still use them.
+         */
+        void publishOutlets(const ulong from) noexcept;
+        
+        //! @internal Retrieve an outlet for the sending methods.
+        /** The function reads the outlets of the published table without lock, the others and the ones of the table while it's rewritten are copied in the holder with the mutex locked.
+         */
+        Outlet* findOutlet(const ulong index, sOutlet& holder) const noexcept;
+        
+        //! @internal Borrow a vector of atoms from the pool of the thread.
+        /** The vectors are borrowed and returned in the reverse order, a returned vector is cleared but keeps its memory.
+         */
+        static Vector& acquireVector() noexcept;
+        
+        //! @internal Return the last vector of atoms borrowed from the pool of the thread.
+        static void releaseVector() noexcept;
     public:
         
         //! Constructor.
@@ -352,7 +394,7 @@ namespace Kiwi
         sInlet getInlet(ulong index) noexcept;
         
         //! Retrieve the dsp index of an inlet.
-        /** The functions retrieves the dsp index of an inlet.
+        /** The functions retrieves the dsp index of an inlet, the number of signal inlets before it. The indices are cached when the inlets change so the function doesn't count the inlets.
          @param index The inlet's index.
          @return The dsp index of the inlet.
          */
@@ -391,7 +433,7 @@ namespace Kiwi
         sOutlet getOutlet(ulong index) noexcept;
         
         //! Retrieve the dsp index of an outlet.
-        /** The functions retrieves the dsp index of an outlet.
+        /** The functions retrieves the dsp index of an outlet, the number of signal outlets before it. The indices are cached when the outlets change so the function doesn't count the outlets.
          @param index The outlet's index.
          @return The dsp index of the outlet.
          */
@@ -403,6 +445,33 @@ namespace Kiwi
          */
         virtual void receive(const ulong index, Vector const& atoms) = 0;
         
+        //! The receive method for a bang.
+        /** The function receives a message without atoms. By default it calls the receive method with an empty vector, the objects can override it to avoid the vector.
+         @param index The index of the inlet.
+         */
+        virtual void receiveBang(const ulong index);
+        
+        //! The receive method for a long value.
+        /** The function receives a message with a long value. By default it calls the receive method with a vector of one atom, the objects can override it to avoid the vector and the test of the type of the atom.
+         @param index The index of the inlet.
+         @param value The value.
+         */
+        virtual void receiveLong(const ulong index, const long value);
+        
+        //! The receive method for a double value.
+        /** The function receives a message with a double value. By default it calls the receive method with a vector of one atom, the objects can override it to avoid the vector and the test of the type of the atom.
+         @param index The index of the inlet.
+         @param value The value.
+         */
+        virtual void receiveDouble(const ulong index, const double value);
+        
+        //! The receive method for a tag.
+        /** The function receives a message with a tag. By default it calls the receive method with a vector of one atom, the objects can override it to avoid the vector and the test of the type of the atom.
+         @param index The index of the inlet.
+         @param tag   The tag.
+         */
+        virtual void receiveTag(const ulong index, sTag tag);
+        
         //! Write the object in a dico.
         /** The function writes the object in a dico.
          @param dico The dico.
@@ -425,7 +494,10 @@ namespace Kiwi
          */
         void    send(const ulong index, initializer_list<Atom> il) const noexcept
         {
-            send(index, Vector(il));
+            Vector& atoms = acquireVector();
+            atoms.assign(il);
+            send(index, atoms);
+            releaseVector();
         }
         
         //! Send a vector of atoms via an outlet.
@@ -435,9 +507,48 @@ namespace Kiwi
          */
         void    send(const ulong index, Atom&& atom) const noexcept
         {
-            send(index, Vector({atom}));
+            Vector& atoms = acquireVector();
+            atoms.push_back(move(atom));
+            send(index, atoms);
+            releaseVector();
         }
         
+        //! Send a bang via an outlet.
+        /** The function sends a message without atoms via an outlet, the connected objects receive it with their receiveBang method.
+         @param index The index of the outlet.
+         */
+        void    sendBang(const ulong index) const noexcept;
+        
+        //! Send a long value via an outlet.
+        /** The function sends a long value via an outlet, the connected objects receive it with their receiveLong method.
+         @param index The index of the outlet.
+         @param value The value.
+         */
+        void    sendLong(const ulong index, const long value) const noexcept;
+        
+        //! Send a double value via an outlet.
+        /** The function sends a double value via an outlet, the connected objects receive it with their receiveDouble method.
+         @param index The index of the outlet.
+         @param value The value.
+         */
+        void    sendDouble(const ulong index, const double value) const noexcept;
+        
+        //! Send a tag via an outlet.
+        /** The function sends a tag via an outlet, the connected objects receive it with their receiveTag method.
+         @param index The index of the outlet.
+         @param tag   The tag.
+         */
+        void    sendTag(const ulong index, sTag tag) const noexcept;
+        
+        //! Defer the sending of a vector of atoms via an outlet.
+        /** The function posts the message to the scheduler of the instance that sends it via the outlet from its own thread. The function never locks and doesn't allocate memory as long as the atoms fit the capacity of the scheduler, so it can be called from the dsp thread.
+         @param index The index of the outlet.
+         @param atoms A list of atoms to pass.
+         @return True if the message has been posted, false if the scheduler is full or the instance doesn't exist anymore.
+         @see Scheduler
+         */
+        bool    defer(const ulong index, Vector const& atoms) const noexcept;
+        
         //! Add a new inlet to the object.
         /** The function adds a new inlet to the object.
          @param type The type of the inlet.
@@ -453,13 +564,13 @@ namespace Kiwi
         void    addOutlet(Io::Type type, string const& description = "");
         
         //! Remove an inlet from the object.
-        /** The function removes an inlet from the object.
+        /** The function removes an inlet from the object. The links of the inlet are removed and the links of the next inlets are renumbered by the patcher, only the links whose dsp indices change are recreated in the dsp chain.
          @param index The index of the inlet.
          */
         void    removeInlet(const ulong index);
         
         //! Remove an outlet from the object.
-        /** The function removes an outlet from the object.
+        /** The function removes an outlet from the object. The links of the outlet are removed and the links of the next outlets are renumbered by the patcher, only the links whose dsp indices change are recreated in the dsp chain.
          @param index The outlet of the inlet.
          */
         void    removeOutlet(const ulong index);
@@ -630,12 +741,61 @@ namespace Kiwi
     class Object::Iolet : public enable_shared_from_this<Iolet>
     {
     protected:
-        vector<Connection>  m_connections;
+        //! @internal The connections as they are seen by the dispatch.
+        /** The connections are stored in parallel arrays. The raw pointers of the objects and the indices of the inlets are contiguous for the dispatch. The shared pointers only keep the receivers of an outlet alive during a dispatch, they're empty for an inlet so the links never make an ownership cycle.
+         */
+        struct Receivers
+        {
+            vector<Object*> objects;
+            vector<ulong>   indices;
+            vector<wObject> references;
+            vector<sObject> owners;
+        };
+        typedef shared_ptr<const Receivers> scReceivers;
+        
+        //! @internal The key of a connection for the membership tests.
+        struct Key
+        {
+            const Object*   object;
+            ulong           index;
+            
+            inline bool operator==(Key const& other) const noexcept
+            {
+                return object == other.object && index == other.index;
+            }
+        };
+        
+        struct KeyHash
+        {
+            inline size_t operator()(Key const& key) const noexcept
+            {
+                return hash<const Object*>()(key.object) ^ (hash<ulong>()(key.index) << 1);
+            }
+        };
+        
+        scReceivers                 m_receivers;
+        unordered_set<Key, KeyHash> m_keys;
         const Io::Type      m_type;
         const Io::Polarity  m_polarity;
         const string        m_description;
+        const bool          m_owner;
         mutable mutex       m_mutex;
         
+        //! @internal Retrieve the current snapshot of the connections.
+        /** The function retrieves the snapshot of the connections without locking the iolet. The snapshot is never modified, the append and erase methods publish a new one.
+         @return The snapshot of the connections.
+         */
+        inline scReceivers getReceivers() const noexcept
+        {
+            return atomic_load(&m_receivers);
+        }
+        
+        //! @internal Publish a new snapshot of the connections.
+        /** The function is called by the append and erase methods while the iolet is locked.
+         @param receivers The new snapshot of the connections.
+         */
+        virtual void publish(scReceivers receivers) noexcept;
+        
     public:
         //! Check if a connection is in the iolet.
         /** The functions checks if a connection is in the iolet.
@@ -660,14 +820,26 @@ namespace Kiwi
          @return true if the connection has been removed, otherwise false.
          */
         bool erase(sObject object, ulong index) noexcept;
+        
+        //! Change the index of a connection of the iolet.
+        /** The functions changes the index of the iolet of a connection and keeps its position in the iolet.
+         @param object   The object.
+         @param index    The iolet's index.
+         @param newindex The new iolet's index.
+         @return true if the connection has been changed, otherwise false.
+         */
+        bool renumber(sObject object, ulong index, ulong newindex) noexcept;
     
         //! Constructor.
         /** You should never call this method except if you really know what you're doing.
+         @param owner If the iolet keeps its connected objects alive.
          */
-        inline Iolet(Io::Type type, Io::Polarity polarity, string const& description) noexcept :
+        inline Iolet(Io::Type type, Io::Polarity polarity, string const& description, const bool owner = false) noexcept :
+        m_receivers(make_shared<const Receivers>()),
         m_type(type),
         m_polarity(polarity),
-        m_description(description)
+        m_description(description),
+        m_owner(owner)
         {
             ;
         }
@@ -678,7 +850,7 @@ namespace Kiwi
         inline ~Iolet() noexcept
         {
             lock_guard<mutex> guard(m_mutex);
-            m_connections.clear();
+            atomic_store(&m_receivers, scReceivers());
         }
         
         //! Retrieve the type of the iolet.
@@ -714,8 +886,7 @@ namespace Kiwi
          */
         inline ulong getNumberOfConnection() const noexcept
         {
-            lock_guard<mutex> guard(m_mutex);
-            return (ulong)m_connections.size();
+            return (ulong)getReceivers()->objects.size();
         }
         
         //! Retrieve a connection.
@@ -787,7 +958,67 @@ namespace Kiwi
      */
     class Object::Outlet : public Iolet
     {
+    private:
+        friend class Profiler;
+        
+        //! @internal A message waiting to be dispatched by the iterative dispatch.
+        struct Task
+        {
+            scReceivers                 receivers;
+            vector<Object*>::size_type  next;
+            ulong                       depth;
+            Vector                      atoms;
+        };
+        
+        //! @internal The work stack of the iterative dispatch of a thread.
+        struct Stack
+        {
+            vector<Task>    tasks;
+            vector<Task>    pending;
+            vector<Vector>  spares;
+            ulong           depth;
+            bool            running;
+        };
+        
+        static inline atomic_bool& getIterativeState() noexcept
+        {
+            static atomic_bool _state(false);
+            return _state;
+        }
+        
+        static inline Stack& getStack() noexcept
+        {
+            static thread_local Stack _stack = {{}, {}, {}, 0, false};
+            return _stack;
+        }
+        
+        atomic<const Receivers*>    m_table;
+        mutable vector<scReceivers> m_retired;
+        mutable atomic_bool         m_dirty;
+        mutable atomic_ulong        m_readers;
+        mutable Records             m_records;
+        
+        //! @internal Publish a new snapshot of the connections and retire the previous one.
+        void publish(scReceivers receivers) noexcept override;
+        
+        //! @internal Release the retired snapshots when the last dispatch leaves.
+        void release() const noexcept;
+        
+        //! @internal Create a task with a vector of atoms recycled from the previous tasks.
+        static Task createTask(Stack& stack, scReceivers receivers, const ulong depth, Vector const& atoms);
+        
+        //! @internal The recursive and the iterative dispatch.
+        template<class ...Parameters, class ...Arguments>
+        void sendRecursive(void (Object::*method)(const ulong, Parameters...), Arguments&&... arguments) const noexcept;
+        void sendIterative(Vector const& atoms) const noexcept;
+        
+        //! @internal Send an atom with the iterative dispatch.
+        void sendIterative(Atom&& atom) const noexcept;
+        
     public:
+        //! The maximum depth of a message with the iterative dispatch.
+        static const ulong maximumDepth = 65536;
+        
         //! Constructor.
         /** You should never call this method except if you really know what you're doing.
          @param type        The type of the outlet.
@@ -801,10 +1032,51 @@ namespace Kiwi
         ~Outlet();
         
         //! Send a vector of atoms to the connected inlets.
-        /** The function sends of atoms to the connected inlets.
+        /** The function sends of atoms to the connected inlets. The dispatch reads a table of the connections compiled each time they change, so it never locks the outlet and the connections can be modified while a message is sent.
          @param atoms The vector of atoms.
          */
         void send(Vector const& atoms) const noexcept;
+        
+        //! Send a bang to the connected inlets.
+        /** The function sends a message without atoms to the connected inlets. The objects receive it with their receiveBang method, with the iterative dispatch they receive an empty vector.
+         */
+        void sendBang() const noexcept;
+        
+        //! Send a long value to the connected inlets.
+        /** The function sends a long value to the connected inlets. The objects receive it with their receiveLong method, with the iterative dispatch they receive a vector of one atom.
+         @param value The value.
+         */
+        void sendLong(const long value) const noexcept;
+        
+        //! Send a double value to the connected inlets.
+        /** The function sends a double value to the connected inlets. The objects receive it with their receiveDouble method, with the iterative dispatch they receive a vector of one atom.
+         @param value The value.
+         */
+        void sendDouble(const double value) const noexcept;
+        
+        //! Send a tag to the connected inlets.
+        /** The function sends a tag to the connected inlets. The objects receive it with their receiveTag method, with the iterative dispatch they receive a vector of one atom.
+         @param tag The tag.
+         */
+        void sendTag(sTag tag) const noexcept;
+        
+        //! Set the dispatch mode of the outlets.
+        /** The function sets if the messages are dispatched by recursion or with the iterative dispatch. The iterative dispatch doesn't use the native stack: the messages sent by an object while it receives a message are stacked and delivered after it returns, in the order they have been sent and depth first, so the right-to-left ordering of the objects is kept. Each thread has its own work stack. The depth of the messages is limited by maximumDepth instead of 256 per object.
+         @param state True to use the iterative dispatch, false to use the recursion.
+         */
+        static void setIterative(const bool state) noexcept
+        {
+            getIterativeState() = state;
+        }
+        
+        //! Retrieve the dispatch mode of the outlets.
+        /** The function retrieves if the messages are dispatched with the iterative dispatch.
+         @return True if the iterative dispatch is used, false if the messages are dispatched by recursion.
+         */
+        static bool isIterative() noexcept
+        {
+            return getIterativeState();
+        }
     };
         
     // ================================================================================ //
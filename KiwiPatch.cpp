@@ -27,6 +27,7 @@
 #include "KiwiConsole.h"
 #include "KiwiPatcherController.h"
 #include "KiwiPatcherWindow.h"
+#include "KiwiPatcherBinary.h"
 
 namespace Kiwi
 {    
@@ -37,7 +38,14 @@ namespace Kiwi
     Patcher::Patcher(sInstance instance) noexcept :
     GuiModel(instance),
     DspChain(instance),
-    m_instance(instance)
+    m_instance(instance),
+    m_arena(make_shared<Arena>()),
+    m_objects_snapshot(make_shared<const vector<sObject>>()),
+    m_links_snapshot(make_shared<const vector<sLink>>()),
+    m_ids_snapshot(make_shared<const vector<sObject>>()),
+    m_loaded(true),
+    m_parallel(false),
+    m_loader(thread::id())
     {
         createAttr(Tags::unlocked_bgcolor,  "Unlocked Background Color",    "Appearance",   Color(0.88, 0.89, 0.88, 1.));
         createAttr(Tags::locked_bgcolor,    "Locked Background Color",      "Appearance",   Color(0.88, 0.89, 0.88, 1.));
@@ -47,11 +55,12 @@ namespace Kiwi
     Patcher::~Patcher()
     {
         m_links.clear();
+        m_ids.clear();
         m_objects.clear();
         m_free_ids.clear();
     }
     
-    sPatcher Patcher::create(sInstance instance, Dico& dico)
+    sPatcher Patcher::create(sInstance instance, Dico& dico, const bool lazy)
     {
         sPatcher patcher = make_shared<Patcher>(instance);
         if(patcher)
@@ -61,33 +70,127 @@ namespace Kiwi
             auto it = dico.find(Tags::patcher);
             if(it != dico.end())
             {
-                patcher->add(it->second);
+                Dico subpatcher(it->second);
+                bool dsp = false;
+                if(lazy)
+                {
+                    // The dsp chain needs the objects so a patcher with dsp objects is never lazy.
+                    auto objects = subpatcher.find(Tags::objects);
+                    if(objects != subpatcher.end() && objects->second.isVector())
+                    {
+                        Vector const& atoms = objects->second;
+                        for(Vector::size_type i = 0; i < atoms.size() && !dsp; i++)
+                        {
+                            Dico object(atoms[i]);
+                            auto name = object.find(Tags::name);
+                            dsp = name != object.end() && name->second.isTag() && Factory::isDsp(name->second);
+                        }
+                    }
+                }
+                
+                if(lazy && !dsp)
+                {
+                    lock_guard<mutex> guard(patcher->m_pending_mutex);
+                    patcher->m_pending = subpatcher;
+                    patcher->m_loaded  = false;
+                }
+                else
+                {
+                    patcher->add(subpatcher);
+                }
             }
         }
         return patcher;
     }
     
-    void Patcher::createObject(Dico& dico)
+    void Patcher::load() noexcept
     {
-        sObject object;
-        if(dico.count(Tags::name))
+        lock_guard<mutex> guard(m_pending_mutex);
+        if(!m_loaded)
         {
-            object = Factory::create(dico[Tags::name], Infos(getInstance(), getShared(), ulong(dico[Tags::id]), sTag(dico[Tags::name]), sTag(dico[Tags::text])->getName(), dico, dico[Tags::arguments]));
-            if(object)
+            m_loader = this_thread::get_id();
+            try
             {
-                sDspNode dspnode = dynamic_pointer_cast<DspNode>(object);
-                if(dspnode)
-                {
-                    DspChain::add(dspnode);
-                }
-                m_objects.push_back(object);
-                m_listeners.call(&Listener::objectCreated, getShared(), object);
-                object->loaded();
+                add(m_pending);
+            }
+            catch(exception& e)
+            {
+                Console::error(string("The patcher can't be loaded : ") + e.what());
             }
+            catch(...)
+            {
+                Console::error("The patcher can't be loaded.");
+            }
+            m_pending.clear();
+            m_loaded = true;
+            m_loader = thread::id();
+        }
+    }
+    
+    void Patcher::publish(const bool objects, const bool ids, const bool links)
+    {
+        if(objects)
+        {
+            atomic_store(&m_objects_snapshot, scObjects(make_shared<const vector<sObject>>(m_objects)));
+        }
+        if(ids)
+        {
+            // The ids are given from one without holes but the free ones, so the table is a vector indexed by the ids.
+            ulong size = 0;
+            for(auto const& object : m_objects)
+            {
+                size = max(size, object->getId());
+            }
+            shared_ptr<vector<sObject>> table = make_shared<vector<sObject>>(vector<sObject>::size_type(size));
+            for(auto const& object : m_objects)
+            {
+                (*table)[vector<sObject>::size_type(object->getId() - 1)] = object;
+            }
+            atomic_store(&m_ids_snapshot, scObjects(table));
+        }
+        if(links)
+        {
+            atomic_store(&m_links_snapshot, scLinks(make_shared<const vector<sLink>>(m_links)));
+        }
+    }
+    
+    ulong Patcher::createId(const ulong pending) noexcept
+    {
+        if(!m_free_ids.empty())
+        {
+            const ulong id = m_free_ids.back();
+            m_free_ids.pop_back();
+            return id;
+        }
+        return ulong(m_objects.size()) + pending + 1;
+    }
+    
+    void Patcher::releaseId(const ulong id) noexcept
+    {
+        m_free_ids.push_back(id);
+    }
+    
+    sObject Patcher::constructObject(Dico& dico)
+    {
+        if(dico.count(Tags::name))
+        {
+            return Factory::create(dico[Tags::name], Infos(getInstance(), getShared(), ulong(dico[Tags::id]), sTag(dico[Tags::name]), sTag(dico[Tags::text])->getName(), dico, dico[Tags::arguments]));
         }
+        return nullptr;
     }
     
-    void Patcher::createLink(Dico const& dico)
+    sObject Patcher::createObject(Dico& dico)
+    {
+        sObject object = constructObject(dico);
+        if(object)
+        {
+            m_objects.push_back(object);
+            m_ids[object->getId()] = object;
+        }
+        return object;
+    }
+    
+    sLink Patcher::createLink(Dico const& dico)
     {
         if(dico.count(Tags::from) && dico.at(Tags::from).isVector() &&
            dico.count(Tags::to) && dico.at(Tags::to).isVector())
@@ -96,8 +199,8 @@ namespace Kiwi
             Vector const& vto    = dico.at(Tags::to);
             if(vfrom.size() > 1 && vto.size() > 1)
             {
-                const sObject from = getObjectWithId(vfrom[0]);
-                const sObject to   = getObjectWithId(vto[0]);
+                const sObject from = findObject(vfrom[0]);
+                const sObject to   = findObject(vto[0]);
                 if(from && to)
                 {
                     const Object::sOutlet outlet  = from->getOutlet(vfrom[1]);
@@ -108,51 +211,49 @@ namespace Kiwi
                         {
                             sDspNode pfrom = dynamic_pointer_cast<DspNode>(from);
                             sDspNode pto   = dynamic_pointer_cast<DspNode>(to);
-                            if(from && to)
+                            if(pfrom && pto)
                             {
                                 ulong poutlet, pinlet;
                                 try
                                 {
-                                    pinlet = from->getDspInletIndex(vfrom[1]);
+                                    poutlet = from->getDspOutletIndex(vfrom[1]);
                                 }
                                 catch(Error& e)
                                 {
                                     Console::post(e.what());
-                                    return;
+                                    return nullptr;
                                 }
                                 
                                 try
                                 {
-                                    poutlet = from->getDspOutletIndex(vto[1]);
+                                    pinlet = to->getDspInletIndex(vto[1]);
                                 }
                                 catch(Error& e)
                                 {
                                     Console::post(e.what());
-                                    return;
+                                    return nullptr;
                                 }
                                 
-                                outlet->append(to, vfrom[1]);
-                                inlet->append(from, vto[1]);
+                                outlet->append(to, vto[1]);
+                                inlet->append(from, vfrom[1]);
                                 Object::Io::Type type = Object::Io::Signal;
                                 if(outlet->getType() == Object::Io::Both && inlet->getType() == Object::Io::Both)
                                 {
                                     type = Object::Io::Both;
                                 }
-                                shared_ptr<Link::SignalLink> link = make_shared<Link::SignalLink>(getShared(), from, vfrom[1], to, vto[1], type, pfrom, poutlet, pto, pinlet);
-                                
-                                DspChain::add(link);
+                                shared_ptr<Link::SignalLink> link = Arena::create<Link::SignalLink>(m_arena, getShared(), from, vfrom[1], to, vto[1], type, pfrom, poutlet, pto, pinlet);
                                 m_links.push_back(link);
-                                m_listeners.call(&Listener::linkCreated, getShared(), link);
+                                return link;
                             }
                         }
                         else if(outlet->getType() == inlet->getType() || inlet->getType() == Object::Io::Both || outlet->getType() == Object::Io::Both)
                         {
                             
-                            outlet->append(to, vfrom[1]);
-                            inlet->append(from, vto[1]);
-                            sLink link = make_shared<Link>(getShared(), from, vfrom[1], to, vto[1], Object::Io::Message);
+                            outlet->append(to, vto[1]);
+                            inlet->append(from, vfrom[1]);
+                            sLink link = Arena::create<Link>(m_arena, getShared(), from, vfrom[1], to, vto[1], Object::Io::Message);
                             m_links.push_back(link);
-                            m_listeners.call(&Listener::linkCreated, getShared(), link);
+                            return link;
                         }
                     }
                 }
@@ -170,10 +271,192 @@ namespace Kiwi
         {
             throw Error("The dico isn't valid for a link creation.");
         }
+        return nullptr;
+    }
+    
+    sObject Patcher::addObject(Dico& dico, unordered_map<ulong, ulong>& ids)
+    {
+        const ulong r_id = dico[Tags::id];
+        const ulong n_id = createId();
+        dico[Tags::id] = (long)n_id;
+        sObject object;
+        try
+        {
+            object = createObject(dico);
+        }
+        catch(...)
+        {
+            releaseId(n_id);
+            throw;
+        }
+        if(object)
+        {
+            ids[r_id] = n_id;
+        }
+        else
+        {
+            releaseId(n_id);
+        }
+        return object;
+    }
+    
+    void Patcher::addObjects(vector<Dico>& dicos, unordered_map<ulong, ulong>& ids, vector<sObject>& objects)
+    {
+        // The objects of a lazy patcher are created one after the other because the loading thread holds the pending
+        // mutex and a constructor that reads the patcher from a worker thread would wait for the loading forever.
+        const sInstance instance = getInstance();
+        if(!m_parallel || !instance || dicos.size() < 2 || m_loader.load() != thread::id())
+        {
+            for(auto& dico : dicos)
+            {
+                sObject object = addObject(dico, ids);
+                if(object)
+                {
+                    objects.push_back(object);
+                }
+            }
+            return;
+        }
+        
+        // The ids are given in the order of the dicos before the creation so they don't depend on the scheduling,
+        // all the ids already given are counted because their objects aren't added yet.
+        const vector<Dico>::size_type size = dicos.size();
+        vector<ulong> rids(size), nids(size);
+        for(vector<Dico>::size_type i = 0; i < size; i++)
+        {
+            rids[i] = dicos[i][Tags::id];
+            nids[i] = createId(ulong(i));
+            dicos[i][Tags::id] = (long)nids[i];
+        }
+        
+        vector<sObject>         created(size);
+        vector<exception_ptr>   errors(size);
+        instance->getExecutor().parallel(ulong(size), [this, &dicos, &created, &errors](ulong index)
+        {
+            try
+            {
+                created[index] = constructObject(dicos[index]);
+            }
+            catch(...)
+            {
+                errors[index] = current_exception();
+            }
+        });
+        
+        // The objects are added in the order of the dicos and the first error stops the creation as the sequential creation does.
+        for(vector<Dico>::size_type i = 0; i < size; i++)
+        {
+            if(errors[i])
+            {
+                for(vector<Dico>::size_type j = i; j < size; j++)
+                {
+                    releaseId(nids[j]);
+                }
+                rethrow_exception(errors[i]);
+            }
+            else if(created[i])
+            {
+                m_objects.push_back(created[i]);
+                m_ids[nids[i]] = created[i];
+                ids[rids[i]] = nids[i];
+                objects.push_back(created[i]);
+            }
+            else
+            {
+                releaseId(nids[i]);
+            }
+        }
+    }
+    
+    sLink Patcher::addLink(Dico& dico, unordered_map<ulong, ulong> const& ids)
+    {
+        // The links refer to the ids of the dico, they are rewritten with the ids of the patcher
+        // and the links to objects that haven't been created are ignored.
+        for(sTag const& key : {Tags::from, Tags::to})
+        {
+            auto li = dico.find(key);
+            if(li == dico.end() || !li->second.isVector())
+            {
+                return nullptr;
+            }
+            Vector const& atoms = li->second;
+            if(atoms.size() < 2)
+            {
+                return nullptr;
+            }
+            auto id = ids.find((ulong)atoms[0]);
+            if(id == ids.end())
+            {
+                return nullptr;
+            }
+            li->second = {(long)id->second, atoms[1]};
+        }
+        return createLink(dico);
+    }
+    
+    void Patcher::commit(vector<sObject> const& objects, vector<sLink> const& links)
+    {
+        publish(!objects.empty(), !objects.empty(), !links.empty());
+        for(auto object : objects)
+        {
+            sDspNode dspnode = dynamic_pointer_cast<DspNode>(object);
+            if(dspnode)
+            {
+                DspChain::add(dspnode);
+            }
+        }
+        for(auto link : links)
+        {
+            sDspLink dsplink = dynamic_pointer_cast<DspLink>(link);
+            if(dsplink)
+            {
+                DspChain::add(dsplink);
+            }
+        }
+        
+        if(!objects.empty())
+        {
+            m_listeners.call(&Listener::objectsCreated, getShared(), objects);
+        }
+        if(!links.empty())
+        {
+            m_listeners.call(&Listener::linksCreated, getShared(), links);
+        }
+        for(auto object : objects)
+        {
+            object->loaded();
+        }
+    }
+    
+    void Patcher::rollback(vector<sObject> const& objects, vector<sLink> const& links) noexcept
+    {
+        unordered_set<const Link*> nlinks;
+        for(auto const& link : links)
+        {
+            disconnect(link);
+            nlinks.insert(link.get());
+        }
+        m_links.erase(remove_if(m_links.begin(), m_links.end(), [&nlinks](sLink const& link)
+        {
+            return nlinks.count(link.get()) != 0;
+        }), m_links.end());
+        
+        unordered_set<const Object*> nobjects;
+        for(auto const& object : objects)
+        {
+            m_ids.erase(object->getId());
+            releaseId(object->getId());
+            nobjects.insert(object.get());
+        }
+        m_objects.erase(remove_if(m_objects.begin(), m_objects.end(), [&nobjects](sObject const& object)
+        {
+            return nobjects.count(object.get()) != 0;
+        }), m_objects.end());
     }
     
     void Patcher::add(Dico const& dico)
     {
+        loadIfNeeded();
         Vector objects, links;
         auto it = dico.find(Tags::objects);
         if(it != dico.end())
@@ -186,83 +469,188 @@ namespace Kiwi
             links = it->second;
         }
 
+        // The whole dico is added as one transaction, the dsp chain and the listeners
+        // receive all the new objects and links once everything has been created.
         lock_guard<mutex> guard(m_mutex);
+        vector<sObject> nobjects;
+        vector<sLink>   nlinks;
+        unordered_map<ulong, ulong> ids;
+        vector<Dico>    dicos;
+        nobjects.reserve(objects.size());
+        nlinks.reserve(links.size());
+        ids.reserve(objects.size());
+        dicos.reserve(objects.size());
         for(vector<sObject>::size_type i = 0; i < objects.size(); i++)
         {
             Dico objdico(objects[i]);
             if(!objdico.empty())
             {
-                const ulong r_id = objdico[Tags::id];
-                const ulong n_id = m_free_ids.empty() ? m_objects.size() + 1 : m_free_ids[0];
-                if(!m_free_ids.empty())
-                {
-                    m_free_ids.erase(m_free_ids.begin());
-                }
-                objdico[Tags::id] = (long)n_id;
-                Vector atoms;
-                for(vector<sLink>::size_type i = 0; i < links.size(); i++)
+                dicos.push_back(move(objdico));
+            }
+        }
+        
+        // If a creation fails, the objects and the links already created are removed before the error is thrown.
+        try
+        {
+            addObjects(dicos, ids, nobjects);
+            for(vector<sLink>::size_type i = 0; i < links.size(); i++)
+            {
+                Dico linkdico(links[i]);
+                if(!linkdico.empty())
                 {
-                    atoms = objdico[Tags::from];
-                    if(atoms.size() > 1 && r_id == (ulong)atoms[0])
-                    {
-                        objdico[Tags::from] = {(long)n_id, atoms[1]};
-                    }
-            
-                    atoms = objdico[Tags::to];
-                    if(atoms.size() > 1 && r_id == (ulong)atoms[0])
+                    sLink link = addLink(linkdico, ids);
+                    if(link)
                     {
-                        objdico[Tags::to] = {(long)n_id, atoms[1]};
+                        nlinks.push_back(link);
                     }
                 }
-                createObject(objdico);
             }
         }
+        catch(...)
+        {
+            rollback(nobjects, nlinks);
+            throw;
+        }
+        
+        commit(nobjects, nlinks);
+    }
+    
+    void Patcher::add(Binary const& binary)
+    {
+        loadIfNeeded();
+        const ulong nobjs = binary.getNumberOfObjects();
+        const ulong nlnks = binary.getNumberOfLinks();
+        
+        lock_guard<mutex> guard(m_mutex);
+        vector<sObject> nobjects;
+        vector<sLink>   nlinks;
+        unordered_map<ulong, ulong> ids;
+        vector<Dico>    dicos;
+        nobjects.reserve(nobjs);
+        nlinks.reserve(nlnks);
+        ids.reserve(nobjs);
+        dicos.reserve(nobjs);
+        for(ulong i = 0; i < nobjs; i++)
+        {
+            Dico objdico;
+            binary.readObject(i, objdico);
+            if(!objdico.empty())
+            {
+                dicos.push_back(move(objdico));
+            }
+        }
+        
+        // If a creation fails, the objects and the links already created are removed before the error is thrown.
+        try
+        {
+            addObjects(dicos, ids, nobjects);
+            for(ulong i = 0; i < nlnks; i++)
+            {
+                Dico linkdico;
+                binary.readLink(i, linkdico);
+                sLink link = addLink(linkdico, ids);
+                if(link)
+                {
+                    nlinks.push_back(link);
+                }
+            }
+        }
+        catch(...)
+        {
+            rollback(nobjects, nlinks);
+            throw;
+        }
         
-        for(vector<sLink>::size_type i = 0; i < links.size(); i++)
+        commit(nobjects, nlinks);
+    }
+    
+    void Patcher::disconnect(sLink link) noexcept
+    {
+        const sObject from = link->getObjectFrom();
+        const sObject to   = link->getObjectTo();
+        if(from && to)
         {
-            Dico linkdico(links[i]);
-            if(!linkdico.empty())
+            Object::sOutlet outlet = from->getOutlet(link->getOutletIndex());
+            if(outlet)
             {
-                createLink(linkdico);
+                outlet->erase(to, link->getInletIndex());
+            }
+            Object::sInlet inlet = to->getInlet(link->getInletIndex());
+            if(inlet)
+            {
+                inlet->erase(from, link->getOutletIndex());
             }
         }
+        link->detach();
     }
     
     void Patcher::remove(sObject object)
     {
         if(object)
         {
-            lock_guard<mutex> guard(m_mutex);
-            auto it = find(m_objects.begin(), m_objects.end(), object);
-            if(it != m_objects.end())
+            remove(vector<sObject>(1, object));
+        }
+    }
+    
+    void Patcher::remove(vector<sObject> const& objects)
+    {
+        lock_guard<mutex> guard(m_mutex);
+        vector<sObject> removed;
+        unordered_set<const Object*> found;
+        removed.reserve(objects.size());
+        for(auto const& object : objects)
+        {
+            if(object && findObject(object->getId()) == object && found.insert(object.get()).second)
             {
-                for(auto li = m_links.begin(); li != m_links.end();)
-                {
-                    if((*li)->getObjectFrom() == object || (*li)->getObjectTo() == object)
-                    {
-                        sDspLink dsplink = dynamic_pointer_cast<DspLink>((*li));
-                        if(dsplink)
-                        {
-                            DspChain::remove(dsplink);
-                        }
-                    }
-                    else
-                    {
-                        ++li;
-                    }
-                }
-                
-                sDspNode dspnode = dynamic_pointer_cast<DspNode>(object);
-                if(dspnode)
+                removed.push_back(object);
+            }
+        }
+        if(removed.empty())
+        {
+            return;
+        }
+        
+        bool unlinked = false;
+        for(auto li = m_links.begin(); li != m_links.end();)
+        {
+            if(found.count((*li)->getObjectFrom().get()) || found.count((*li)->getObjectTo().get()))
+            {
+                sDspLink dsplink = dynamic_pointer_cast<DspLink>(*li);
+                if(dsplink)
                 {
-                    DspChain::remove(dspnode);
+                    DspChain::remove(dsplink);
                 }
-                
-                m_listeners.call(&Listener::objectRemoved, getShared(), object);
-                m_objects.erase(it);
-                m_free_ids.push_back(object->getId());
+                disconnect(*li);
+                m_listeners.call(&Listener::linkRemoved, getShared(), (*li));
+                li = m_links.erase(li);
+                unlinked = true;
+            }
+            else
+            {
+                ++li;
+            }
+        }
+        
+        for(auto const& object : removed)
+        {
+            sDspNode dspnode = dynamic_pointer_cast<DspNode>(object);
+            if(dspnode)
+            {
+                DspChain::remove(dspnode);
             }
         }
+        
+        for(auto const& object : removed)
+        {
+            m_listeners.call(&Listener::objectRemoved, getShared(), object);
+            m_ids.erase(object->getId());
+            releaseId(object->getId());
+        }
+        m_objects.erase(remove_if(m_objects.begin(), m_objects.end(), [&found](sObject const& object)
+        {
+            return found.count(object.get()) != 0;
+        }), m_objects.end());
+        publish(true, true, unlinked);
     }
     
     void Patcher::remove(sLink link)
@@ -278,9 +666,149 @@ namespace Kiwi
                 {
                     DspChain::remove(dsplink);
                 }
+                disconnect(link);
                 
                 m_listeners.call(&Listener::linkRemoved, getShared(), link);
                 m_links.erase(it);
+                publish(false, false, true);
+            }
+        }
+    }
+    
+    void Patcher::detachIolet(sObject object, const ulong index, const bool inlet)
+    {
+        if(object)
+        {
+            lock_guard<mutex> guard(m_mutex);
+            bool signal;
+            if(inlet)
+            {
+                Object::sInlet iolet = object->getInlet(index);
+                signal = iolet && (iolet->getType() & Object::Io::Signal);
+            }
+            else
+            {
+                Object::sOutlet iolet = object->getOutlet(index);
+                signal = iolet && (iolet->getType() & Object::Io::Signal);
+            }
+            
+            bool changed = false;
+            
+            // The links of the removed iolet are disconnected first so their connections are free for the links of the next iolets.
+            vector<vector<sLink>::size_type> nexts;
+            for(auto li = m_links.begin(); li != m_links.end();)
+            {
+                const sLink link = *li;
+                const sObject from = link->getObjectFrom();
+                const sObject to   = link->getObjectTo();
+                const ulong current = inlet ? link->getInletIndex() : link->getOutletIndex();
+                if((inlet ? to : from) != object || current < index || !from || !to)
+                {
+                    ++li;
+                    continue;
+                }
+                
+                changed = true;
+                if(current == index)
+                {
+                    sDspLink dsplink = dynamic_pointer_cast<DspLink>(link);
+                    if(dsplink)
+                    {
+                        DspChain::remove(dsplink);
+                    }
+                    disconnect(link);
+                    m_listeners.call(&Listener::linkRemoved, getShared(), link);
+                    li = m_links.erase(li);
+                }
+                else
+                {
+                    nexts.push_back(vector<sLink>::size_type(li - m_links.begin()));
+                    ++li;
+                }
+            }
+            
+            // The links of the next iolets are renumbered in the ascending order of the iolets, so the connection
+            // of the previous iolet is always free, and the connections keep their positions in the iolets.
+            stable_sort(nexts.begin(), nexts.end(), [this, inlet](vector<sLink>::size_type a, vector<sLink>::size_type b)
+            {
+                return inlet ? m_links[a]->getInletIndex() < m_links[b]->getInletIndex() : m_links[a]->getOutletIndex() < m_links[b]->getOutletIndex();
+            });
+            
+            vector<sLink> broken;
+            for(auto position : nexts)
+            {
+                const sLink link = m_links[position];
+                const sObject from = link->getObjectFrom();
+                const sObject to   = link->getObjectTo();
+                const ulong outletIndex = link->getOutletIndex();
+                const ulong inletIndex  = link->getInletIndex();
+                const ulong newOutlet = inlet ? outletIndex : outletIndex - 1;
+                const ulong newInlet  = inlet ? inletIndex - 1 : inletIndex;
+                sDspLink dsplink = dynamic_pointer_cast<DspLink>(link);
+                Object::sOutlet outlet = from->getOutlet(outletIndex);
+                Object::sInlet  input  = to->getInlet(inletIndex);
+                bool renumbered;
+                if(inlet)
+                {
+                    renumbered = outlet && outlet->renumber(to, inletIndex, newInlet);
+                }
+                else
+                {
+                    renumbered = input && input->renumber(from, outletIndex, newOutlet);
+                }
+                m_listeners.call(&Listener::linkRemoved, getShared(), link);
+                
+                if(!renumbered)
+                {
+                    // The connection can't be moved, the link is removed so the iolets and the link never disagree.
+                    Console::error("The link can't be renumbered and has been removed.");
+                    if(dsplink)
+                    {
+                        DspChain::remove(dsplink);
+                    }
+                    disconnect(link);
+                    broken.push_back(link);
+                    continue;
+                }
+                
+                if(dsplink && signal)
+                {
+                    // The dsp indices change so the dsp link must be recreated.
+                    sDspNode pfrom = dynamic_pointer_cast<DspNode>(from);
+                    sDspNode pto   = dynamic_pointer_cast<DspNode>(to);
+                    try
+                    {
+                        const ulong poutlet = from->getDspOutletIndex(outletIndex) - (inlet ? 0 : 1);
+                        const ulong pinlet  = to->getDspInletIndex(inletIndex) - (inlet ? 1 : 0);
+                        DspChain::remove(dsplink);
+                        link->detach();
+                        m_links[position] = Arena::create<Link::SignalLink>(m_arena, getShared(), from, newOutlet, to, newInlet, link->getType(), pfrom, poutlet, pto, pinlet);
+                        DspChain::add(dynamic_pointer_cast<DspLink>(m_links[position]));
+                    }
+                    catch(Error& e)
+                    {
+                        Console::error(e.what());
+                        link->setIndices(newOutlet, newInlet);
+                    }
+                }
+                else
+                {
+                    link->setIndices(newOutlet, newInlet);
+                }
+                m_listeners.call(&Listener::linkCreated, getShared(), m_links[position]);
+            }
+            
+            if(!broken.empty())
+            {
+                m_links.erase(remove_if(m_links.begin(), m_links.end(), [&broken](sLink const& link)
+                {
+                    return find(broken.begin(), broken.end(), link) != broken.end();
+                }), m_links.end());
+            }
+            
+            if(changed)
+            {
+                publish(false, false, true);
             }
         }
     }
@@ -295,6 +823,7 @@ namespace Kiwi
             {
                 m_objects.erase(it);
                 m_objects.push_back(object);
+                publish(true, false, false);
             }
         }
     }
@@ -309,51 +838,85 @@ namespace Kiwi
             {
                 m_objects.erase(it);
                 m_objects.insert(m_objects.begin(), object);
+                publish(true, false, false);
             }
         }
     }
 	
     void Patcher::write(Dico& dico) const
     {
-        if(1)
-        {
-            /*
-			Dico& subpatcher = Dico::create();
-			if(subpatcher)
-			{
-                Vector atoms;
-				lock_guard<mutex> guard(m_mutex);
-                
-				for(vector<sObject>::size_type i = 0; i < m_objects.size(); i++)
-				{
-					Dico& object = Dico::create();
-					if(object)
-					{
-						m_objects[i]->write(object);
-                        atoms.push_back(object);
-					}
-				}
-				subpatcher->set(Tags::objects, atoms);
-				
-				atoms.clear();
-				
-				for(vector<sLink>::size_type i = 0; i < m_links.size(); i++)
-				{
-                    Dico& link = Dico::create();
-					if(link)
-					{
-						m_links[i]->write(link);
-						atoms.push_back(link);
-					}
-				}
-				subpatcher->set(Tags::links, atoms);
-				dico->set(Tags::patcher, subpatcher);
-			}*/
+        class DicoWriter : public Writer
+        {
+        public:
+            Vector objects, links;
+            void writeObject(Dico const& object) override {objects.push_back(object);}
+            void writeLink(Dico const& link) override {links.push_back(link);}
+        };
+        
+        DicoWriter writer;
+        write(writer);
+        Dico subpatcher;
+        subpatcher[Tags::objects]   = writer.objects;
+        subpatcher[Tags::links]     = writer.links;
+        dico[Tags::patcher]         = subpatcher;
+    }
+    
+    void Patcher::write(Writer& writer) const
+    {
+        // While a lazy patcher is loaded by another thread, the writer waits for the objects and the links.
+        if(!m_loaded && m_loader.load() != this_thread::get_id())
+        {
+            lock_guard<mutex> guard(m_pending_mutex);
+            if(!m_loaded)
+            {
+                for(sTag const& key : {Tags::objects, Tags::links})
+                {
+                    auto it = m_pending.find(key);
+                    if(it != m_pending.end() && it->second.isVector())
+                    {
+                        Vector const& atoms = it->second;
+                        for(Vector::size_type i = 0; i < atoms.size(); i++)
+                        {
+                            if(key == Tags::objects)
+                            {
+                                writer.writeObject(Dico(atoms[i]));
+                            }
+                            else
+                            {
+                                writer.writeLink(Dico(atoms[i]));
+                            }
+                        }
+                    }
+                }
+                return;
+            }
+        }
+        
+        const scObjects objects = atomic_load(&m_objects_snapshot);
+        const scLinks   links   = atomic_load(&m_links_snapshot);
+        
+        Dico dico;
+        for(vector<sObject>::size_type i = 0; i < objects->size(); i++)
+        {
+            dico.clear();
+            (*objects)[i]->write(dico);
+            writer.writeObject(dico);
+        }
+        
+        for(vector<sLink>::size_type i = 0; i < links->size(); i++)
+        {
+            dico.clear();
+            (*links)[i]->write(dico);
+            if(!dico.empty())
+            {
+                writer.writeLink(dico);
+            }
         }
     }
     
     sGuiWindow Patcher::createWindow()
     {
+        loadIfNeeded();
         sInstance instance = getInstance();
         if(instance)
         {
@@ -371,6 +934,7 @@ namespace Kiwi
     
     sGuiController Patcher::createController()
     {
+        loadIfNeeded();
         return Patcher::Controller::create(getShared());
     }
 }
@@ -38,6 +38,7 @@ namespace Kiwi
      */
     class Patcher : public GuiModel, public DspChain, public Attr::Manager
 	{
+        friend class Object;
     public:
         class Window;
         typedef shared_ptr<Window>              sWindow;
@@ -57,17 +58,87 @@ namespace Kiwi
         typedef shared_ptr<const Listener>      scListener;
         typedef weak_ptr<const Listener>        wcListener;
         
+        class Writer;
+        
+        class Binary;
+        typedef shared_ptr<Binary>              sBinary;
+        typedef weak_ptr<Binary>                wBinary;
+        typedef shared_ptr<const Binary>        scBinary;
+        typedef weak_ptr<const Binary>          wcBinary;
+        
+        typedef shared_ptr<const vector<sObject>>   scObjects;
+        typedef shared_ptr<const vector<sLink>>     scLinks;
+        
     private:
         const wInstance             m_instance;
+        const sArena                m_arena;
         vector<sObject>             m_objects;
+        unordered_map<ulong, sObject> m_ids;
         vector<sLink>               m_links;
         vector<ulong>               m_free_ids;
         mutable mutex               m_mutex;
+        scObjects                   m_objects_snapshot;
+        scLinks                     m_links_snapshot;
+        scObjects                   m_ids_snapshot;
         ListenerSet<Listener>       m_listeners;
+        Dico                        m_pending;
+        atomic_bool                 m_loaded;
+        atomic_bool                 m_parallel;
+        atomic<thread::id>          m_loader;
+        mutable mutex               m_pending_mutex;
 
         //! @internal Object and link creation.
-        void createObject(Dico& dico);
-        void createLink(Dico const& dico);
+        sObject constructObject(Dico& dico);
+        sObject createObject(Dico& dico);
+        sLink createLink(Dico const& dico);
+        
+        //! @internal Object and link creation from a dico with ids to remap.
+        sObject addObject(Dico& dico, unordered_map<ulong, ulong>& ids);
+        sLink addLink(Dico& dico, unordered_map<ulong, ulong> const& ids);
+        
+        //! @internal Objects creation from a set of dicos, sequential or parallel, the objects are added in the order of the dicos.
+        void addObjects(vector<Dico>& dicos, unordered_map<ulong, ulong>& ids, vector<sObject>& objects);
+        
+        //! @internal Add the new objects and links to the dsp chain, notify the listeners and load the objects.
+        void commit(vector<sObject> const& objects, vector<sLink> const& links);
+        
+        //! @internal Remove the new objects and links that haven't been committed because the creation failed, the mutex must be locked.
+        void rollback(vector<sObject> const& objects, vector<sLink> const& links) noexcept;
+        
+        //! @internal Load the pending objects and links if the patcher is lazy.
+        /** The other threads wait until the loading is done, the thread that loads the patcher reads the objects already created.
+         */
+        inline void loadIfNeeded() const noexcept
+        {
+            if(!m_loaded && m_loader.load() != this_thread::get_id())
+            {
+                const_cast<Patcher *>(this)->load();
+            }
+        }
+        
+        //! @internal Publish the snapshots of the objects, the ids and the links for the readers, the mutex must be locked.
+        /** The ids are only published when objects are added or removed because the table of the ids is rebuilt from the objects.
+         */
+        void publish(const bool objects, const bool ids, const bool links);
+        
+        //! @internal Ids allocation, the mutex must be locked.
+        /** The pending number is the number of ids already given, from the free ids or not, whose objects haven't been added yet. The ids in use and the free ids always make the range from one to their count, so the first new id follows the objects, the free ids and the pending ids.
+         */
+        ulong createId(const ulong pending = 0) noexcept;
+        void releaseId(const ulong id) noexcept;
+        
+        //! @internal Erase the connections of a link from its iolets and detach it, so the objects stop receiving messages even if the link is still referenced.
+        void disconnect(sLink link) noexcept;
+        
+        //! @internal Remove the links of an iolet that will be removed and renumber the links of the next iolets.
+        void detachIolet(sObject object, const ulong index, const bool inlet);
+        
+        //! @internal Retrieve an object with its id, the mutex must be locked.
+        inline sObject findObject(const ulong _id) const noexcept
+        {
+            auto it = m_ids.find(_id);
+            return it != m_ids.end() ? it->second : nullptr;
+        }
         
     public:
         //! Constructor.
@@ -81,12 +152,55 @@ namespace Kiwi
         ~Patcher();
         
         //! The patcher creation method.
-        /** The function allocates a patcher and initialize the defaults objects.
+        /** The function allocates a patcher and initialize the defaults objects. If the patcher is lazy, the dico is kept as it is and the objects are only created when they are accessed, when the patcher is viewed or if one of them is a dsp object.
          @param instance The instance that will manage the patcher.
          @param dico The dico that will initialize the patcher.
+         @param lazy If the creation of the objects should be delayed.
          @return The patcher.
          */
-        static sPatcher create(sInstance instance, Dico& dico);
+        static sPatcher create(sInstance instance, Dico& dico, const bool lazy = false);
+        
+        //! Load the objects of a lazy patcher.
+        /** The function creates the pending objects and links of a lazy patcher. If the patcher is already loaded, the function has no effect. The patcher is marked as loaded once the objects and the links have been committed, so the other threads that read the patcher in the meantime wait for the loading. The errors of the creation are posted to the console because the loading can be triggered by the getters that don't throw.
+         */
+        void load() noexcept;
+        
+        //! Retrieve if the objects of the patcher have been created.
+        /** The function retrieves if the objects of the patcher have been created.
+         @return false if the patcher is lazy and hasn't been loaded yet, otherwise true.
+         */
+        inline bool isLoaded() const noexcept
+        {
+            return m_loaded;
+        }
+        
+        //! Set if the objects are created in parallel.
+        /** The function sets if the objects added to the patcher are created concurrently by the executor of the instance. The ids, the links, the order of the objects and the notifications of the listeners are the same as when the objects are created one after the other, only the constructors of the objects must support being called concurrently.
+         @param state True to create the objects in parallel, false to create them one after the other.
+         @see Executor
+         */
+        inline void setParallelLoading(const bool state) noexcept
+        {
+            m_parallel = state;
+        }
+        
+        //! Retrieve if the objects are created in parallel.
+        /** The function retrieves if the objects added to the patcher are created concurrently.
+         @return True if the objects are created in parallel, otherwise false.
+         */
+        inline bool isParallelLoading() const noexcept
+        {
+            return m_parallel;
+        }
+        
+        //! Retrieve the arena of the patcher.
+        /** The function retrieves the arena where the objects, the iolets and the links of the patcher are allocated.
+         @return The arena of the patcher.
+         */
+        inline sArena getArena() const noexcept
+        {
+            return m_arena;
+        }
         
         //! Add a patcher's listener.
         /** The function adds a patcher's listener.
@@ -136,13 +250,23 @@ namespace Kiwi
         }
 
         //! Get the objects.
-        /** The function retrieves the objects from the patcher.
+        /** The function retrieves a copy of the objects from the patcher.
          @return A vector with the objects.
+         @see getObjectsSnapshot
          */
         inline vector<sObject> getObjects() const noexcept
         {
-            lock_guard<mutex> guard(m_mutex);
-            return m_objects;
+            return *getObjectsSnapshot();
+        }
+        
+        //! Get the snapshot of the objects.
+        /** The function retrieves the current snapshot of the objects from the patcher without locking the patcher and without copying the objects. The snapshot is never modified, the changes of the patcher publish a new snapshot, so it can be iterated while the patcher is edited.
+         @return The snapshot of the objects.
+         */
+        inline scObjects getObjectsSnapshot() const noexcept
+        {
+            loadIfNeeded();
+            return atomic_load(&m_objects_snapshot);
         }
         
         //! Get an object with the id.
@@ -151,39 +275,56 @@ namespace Kiwi
          */
         inline sObject getObjectWithId(ulong const _id) const noexcept
         {
-            lock_guard<mutex> guard(m_mutex);
-            for(vector<sObject>::size_type i = 0; i < m_objects.size(); i++)
-            {
-                if(m_objects[i]->getId() == _id)
-                {
-                    return m_objects[i];
-                }
-            }
-            return nullptr;
+            loadIfNeeded();
+            const scObjects ids = atomic_load(&m_ids_snapshot);
+            return _id && _id <= ulong(ids->size()) ? (*ids)[vector<sObject>::size_type(_id - 1)] : nullptr;
         }
         
         //! Get the links.
-        /** The function retrieves the links from the patcher.
+        /** The function retrieves a copy of the links from the patcher.
          @return A vector of links.
+         @see getLinksSnapshot
          */
         vector<sLink> getLinks() const noexcept
         {
-            lock_guard<mutex> guard(m_mutex);
-            return m_links;
+            return *getLinksSnapshot();
+        }
+        
+        //! Get the snapshot of the links.
+        /** The function retrieves the current snapshot of the links from the patcher without locking the patcher and without copying the links.
+         @return The snapshot of the links.
+         @see getObjectsSnapshot
+         */
+        inline scLinks getLinksSnapshot() const noexcept
+        {
+            loadIfNeeded();
+            return atomic_load(&m_links_snapshot);
         }
         
         //! Append a dico.
-        /** The function reads a dico and add the objects and links to the patcher.
+        /** The function reads a dico and add the objects and links to the patcher. The objects and the links are added to the dsp chain and notified to the listeners all at once when everything has been created, then the objects are loaded.
          @param dico The dico.
          */
         void add(Dico const& dico);
         
+        //! Append a binary patcher.
+        /** The function reads the records of a binary patcher and add the objects and links to the patcher. The objects and the links are decoded one by one and the binary patcher is never converted to a dico.
+         @param binary The binary patcher.
+         */
+        void add(Binary const& binary);
+        
         //! Free a object.
         /** The function removes a object from the patcher.
          @param object        The pointer to the object.
          */
         void remove(sObject object);
         
+        //! Free a set of objects.
+        /** The function removes a set of objects and their links from the patcher. The snapshots and the dsp chain are updated once for all the objects.
+         @param objects       The pointers to the objects.
+         */
+        void remove(vector<sObject> const& objects);
+        
         //! Free a link.
         /** The function removes a link from the patcher.
          @param link        The pointer to the link.
@@ -208,6 +349,12 @@ namespace Kiwi
          */
         void write(Dico& dico) const;
         
+        //! Write the patcher with a writer.
+        /** The function writes the objects then the links of the patcher one by one with a writer. Only one dico is used for all the elements and the snapshots of the patcher are written so the patcher isn't locked. A lazy patcher that hasn't been loaded writes its pending dico without creating the objects.
+         @param writer The writer.
+         */
+        void write(Writer& writer) const;
+        
         //! Create a new window for the patcher.
         /** The function creates a new window for the patcher.
          @return The window.
@@ -270,6 +417,18 @@ namespace Kiwi
          */
         virtual void objectCreated(sPatcher patcher, sObject object) = 0;
         
+        //! Receive the notification that a set of objects has been created.
+        /** The function is called by the patcher when a set of objects has been added. By default, the function calls objectCreated for each object.
+         @param objects    The objects.
+         */
+        virtual void objectsCreated(sPatcher patcher, vector<sObject> objects)
+        {
+            for(auto object : objects)
+            {
+                objectCreated(patcher, object);
+            }
+        }
+        
         //! Receive the notification that an object has been removed.
         /** The function is called by the patcher when an object has been removed.
          @param object     The object.
@@ -282,12 +441,52 @@ namespace Kiwi
          */
         virtual void linkCreated(sPatcher patcher, sLink link) = 0;
         
+        //! Receive the notification that a set of links has been created.
+        /** The function is called by the patcher when a set of links has been added. By default, the function calls linkCreated for each link.
+         @param links    The links.
+         */
+        virtual void linksCreated(sPatcher patcher, vector<sLink> links)
+        {
+            for(auto link : links)
+            {
+                linkCreated(patcher, link);
+            }
+        }
+        
         //! Receive the notification that a link has been removed.
         /** The function is called by the patcher when a link has been removed.
          @param link    The link.
          */
         virtual void linkRemoved(sPatcher patcher, sLink link) = 0;
     };
+    
+    // ================================================================================ //
+    //                                  PATCHER WRITER                                  //
+    // ================================================================================ //
+    
+    //! The patcher writer is an abstract class that receives the elements of a patcher while it is written.
+    /**
+     The patcher writer receives the dicos of the objects and the links one after the other so the whole patcher never has to be held in memory. The dicos are only valid during the calls.
+     @see Patcher::write
+     */
+    class Patcher::Writer
+    {
+    public:
+        //! The destructor.
+        virtual ~Writer() {}
+        
+        //! Receive an object.
+        /** The function is called by the patcher for each object.
+         @param object     The dico of the object.
+         */
+        virtual void writeObject(Dico const& object) = 0;
+        
+        //! Receive a link.
+        /** The function is called by the patcher for each link, after all the objects.
+         @param link     The dico of the link.
+         */
+        virtual void writeLink(Dico const& link) = 0;
+    };
 }
 
 
@@ -25,6 +25,7 @@
 #define __DEF_KIWI_PATCHER__
 
 #include "KiwiFactory.h"
+#include "KiwiPatcherBinary.h"
 
 #endif
 
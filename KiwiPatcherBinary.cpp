@@ -0,0 +1,602 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "KiwiPatcherBinary.h"
+#include "KiwiConsole.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                  PATCHER BINARY                                  //
+    // ================================================================================ //
+    
+    static const char       binary_magic[4]     = {'K', 'I', 'W', 'B'};
+    static const uint32_t   binary_version      = 1;
+    static const ulong      binary_header_size  = 32;
+    static const ulong      binary_record_size  = 16;
+    static const ulong      binary_max_depth    = 256;
+    
+    enum BinaryType : char
+    {
+        BinaryUndefined = 0,
+        BinaryLong      = 1,
+        BinaryDouble    = 2,
+        BinaryTag       = 3,
+        BinaryVector    = 4,
+        BinaryDico      = 5
+    };
+    
+    static inline uint32_t readInteger(const char* data) noexcept
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        return uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8) | (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+    }
+    
+    static inline uint64_t readInteger64(const char* data) noexcept
+    {
+        return uint64_t(readInteger(data)) | (uint64_t(readInteger(data + 4)) << 32);
+    }
+    
+    static inline void writeInteger(string& buffer, const uint32_t value)
+    {
+        buffer.push_back(char(value & 0xff));
+        buffer.push_back(char((value >> 8) & 0xff));
+        buffer.push_back(char((value >> 16) & 0xff));
+        buffer.push_back(char((value >> 24) & 0xff));
+    }
+    
+    static inline void writeInteger64(string& buffer, const uint64_t value)
+    {
+        writeInteger(buffer, uint32_t(value & 0xffffffff));
+        writeInteger(buffer, uint32_t(value >> 32));
+    }
+    
+    static Atom decodeAtom(const char* data, ulong& pos, const ulong end, vector<sTag> const& tags, const ulong depth) throw(Error&);
+    
+    static void decodeDico(const char* data, ulong& pos, const ulong end, vector<sTag> const& tags, Dico& dico, const ulong depth = 0) throw(Error&)
+    {
+        // The vectors and the dicos are decoded recursively so the nesting is limited to keep a corrupted file from overflowing the stack.
+        if(depth > binary_max_depth || end - pos < 4)
+        {
+            throw Error("The binary patcher is corrupted.");
+        }
+        const ulong size = readInteger(data + pos);
+        pos += 4;
+        for(ulong i = 0; i < size; i++)
+        {
+            if(end - pos < 4 || readInteger(data + pos) >= tags.size())
+            {
+                throw Error("The binary patcher is corrupted.");
+            }
+            const sTag key = tags[readInteger(data + pos)];
+            pos += 4;
+            dico[key] = decodeAtom(data, pos, end, tags, depth + 1);
+        }
+    }
+    
+    static Atom decodeAtom(const char* data, ulong& pos, const ulong end, vector<sTag> const& tags, const ulong depth) throw(Error&)
+    {
+        if(end - pos < 1)
+        {
+            throw Error("The binary patcher is corrupted.");
+        }
+        const char type = data[pos++];
+        switch(type)
+        {
+            case BinaryUndefined:
+            {
+                return Atom();
+            }
+            case BinaryLong:
+            {
+                if(end - pos < 8)
+                {
+                    throw Error("The binary patcher is corrupted.");
+                }
+                const long value = long(int64_t(readInteger64(data + pos)));
+                pos += 8;
+                return Atom(value);
+            }
+            case BinaryDouble:
+            {
+                if(end - pos < 8)
+                {
+                    throw Error("The binary patcher is corrupted.");
+                }
+                const uint64_t bits = readInteger64(data + pos);
+                double value;
+                memcpy(&value, &bits, sizeof(double));
+                pos += 8;
+                return Atom(value);
+            }
+            case BinaryTag:
+            {
+                if(end - pos < 4 || readInteger(data + pos) >= tags.size())
+                {
+                    throw Error("The binary patcher is corrupted.");
+                }
+                const sTag tag = tags[readInteger(data + pos)];
+                pos += 4;
+                return Atom(tag);
+            }
+            case BinaryVector:
+            {
+                if(depth > binary_max_depth || end - pos < 4)
+                {
+                    throw Error("The binary patcher is corrupted.");
+                }
+                const ulong size = readInteger(data + pos);
+                pos += 4;
+                Vector atoms;
+                atoms.reserve(min(size, end - pos));
+                for(ulong i = 0; i < size; i++)
+                {
+                    atoms.push_back(decodeAtom(data, pos, end, tags, depth + 1));
+                }
+                return Atom(atoms);
+            }
+            case BinaryDico:
+            {
+                Dico dico;
+                decodeDico(data, pos, end, tags, dico, depth);
+                return Atom(dico);
+            }
+            default:
+            {
+                throw Error("The binary patcher is corrupted.");
+            }
+        }
+    }
+    
+    Patcher::Binary::Binary() noexcept :
+    m_data(nullptr),
+    m_size(0),
+    m_mapped(false),
+    m_nobjects(0),
+    m_objects(0),
+    m_nlinks(0),
+    m_links(0)
+    {
+        ;
+    }
+    
+    Patcher::Binary::~Binary()
+    {
+#if defined(_WIN32) || defined(_WIN64)
+#else
+        if(m_mapped)
+        {
+            munmap(const_cast<char *>(m_data), size_t(m_size));
+        }
+#endif
+    }
+    
+    Patcher::sBinary Patcher::Binary::create(string const& path)
+    {
+        sBinary binary = make_shared<Binary>();
+#if defined(_WIN32) || defined(_WIN64)
+        ifstream file(path, ios::binary | ios::ate);
+        if(!file)
+        {
+            Console::error("The binary patcher " + path + " can't be opened.");
+            return nullptr;
+        }
+        binary->m_buffer.resize(size_t(file.tellg()));
+        file.seekg(0);
+        file.read(binary->m_buffer.data(), binary->m_buffer.size());
+        binary->m_data = binary->m_buffer.data();
+        binary->m_size = ulong(binary->m_buffer.size());
+#else
+        const int fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+        {
+            Console::error("The binary patcher " + path + " can't be opened.");
+            return nullptr;
+        }
+        struct stat infos;
+        if(fstat(fd, &infos) == 0 && infos.st_size > 0)
+        {
+            void* data = mmap(nullptr, size_t(infos.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if(data != MAP_FAILED)
+            {
+                binary->m_data = static_cast<const char *>(data);
+                binary->m_size = ulong(infos.st_size);
+                binary->m_mapped = true;
+            }
+        }
+        close(fd);
+#endif
+        try
+        {
+            binary->initialize();
+        }
+        catch(Error& e)
+        {
+            Console::error(path + " : " + e.what());
+            return nullptr;
+        }
+        return binary;
+    }
+    
+    Patcher::sBinary Patcher::Binary::create(const char* data, const ulong size)
+    {
+        sBinary binary = make_shared<Binary>();
+        binary->m_buffer.assign(data, data + size);
+        binary->m_data = binary->m_buffer.data();
+        binary->m_size = size;
+        try
+        {
+            binary->initialize();
+        }
+        catch(Error& e)
+        {
+            Console::error(e.what());
+            return nullptr;
+        }
+        return binary;
+    }
+    
+    uint32_t Patcher::Binary::getInteger(const ulong offset) const noexcept
+    {
+        return readInteger(m_data + offset);
+    }
+    
+    void Patcher::Binary::initialize() throw(Error&)
+    {
+        if(!m_data || m_size < binary_header_size || memcmp(m_data, binary_magic, 4) != 0)
+        {
+            throw Error("The file isn't a binary patcher.");
+        }
+        if(getInteger(4) != binary_version)
+        {
+            throw Error("The version of the binary patcher isn't supported.");
+        }
+        
+        m_nobjects  = getInteger(8);
+        m_objects   = getInteger(12);
+        m_nlinks    = getInteger(16);
+        m_links     = getInteger(20);
+        const ulong ntags   = getInteger(24);
+        const ulong tags    = getInteger(28);
+        // The sizes are compared by division because the products can overflow an ulong.
+        if(m_objects > m_size || m_nobjects > (m_size - m_objects) / binary_record_size ||
+           m_links > m_size || m_nlinks > (m_size - m_links) / binary_record_size ||
+           tags > m_size || ntags > (m_size - tags) / 8)
+        {
+            throw Error("The binary patcher is corrupted.");
+        }
+        
+        for(ulong i = 0; i < m_nobjects; i++)
+        {
+            const ulong record = m_objects + i * binary_record_size;
+            const ulong offset  = getInteger(record + 8);
+            const ulong size    = getInteger(record + 12);
+            if(getInteger(record + 4) >= ntags || offset > m_size || size > m_size - offset)
+            {
+                throw Error("The binary patcher is corrupted.");
+            }
+        }
+        
+        m_tags.resize(ntags);
+        for(ulong i = 0; i < ntags; i++)
+        {
+            const ulong offset  = getInteger(tags + i * 8);
+            const ulong size    = getInteger(tags + i * 8 + 4);
+            if(offset > m_size || size > m_size - offset)
+            {
+                throw Error("The binary patcher is corrupted.");
+            }
+            m_tags[i] = Tag::create(string(m_data + offset, size));
+        }
+    }
+    
+    Patcher::Binary::ObjectRecord Patcher::Binary::getObject(const ulong index) const noexcept
+    {
+        if(index < m_nobjects)
+        {
+            const ulong record = m_objects + index * binary_record_size;
+            return {getInteger(record), m_tags[getInteger(record + 4)], getInteger(record + 12)};
+        }
+        return {0, nullptr, 0};
+    }
+    
+    const char* Patcher::Binary::getObjectData(const ulong index) const noexcept
+    {
+        if(index < m_nobjects)
+        {
+            return m_data + getInteger(m_objects + index * binary_record_size + 8);
+        }
+        return nullptr;
+    }
+    
+    void Patcher::Binary::readObject(const ulong index, Dico& dico) const throw(Error&)
+    {
+        if(index < m_nobjects)
+        {
+            const ulong record  = m_objects + index * binary_record_size;
+            ulong pos           = getInteger(record + 8);
+            const ulong end     = pos + getInteger(record + 12);
+            decodeDico(m_data, pos, end, m_tags, dico);
+            dico[Tags::id]      = (long)getInteger(record);
+            dico[Tags::name]    = m_tags[getInteger(record + 4)];
+        }
+    }
+    
+    Patcher::Binary::LinkRecord Patcher::Binary::getLink(const ulong index) const noexcept
+    {
+        if(index < m_nlinks)
+        {
+            const ulong record = m_links + index * binary_record_size;
+            return {getInteger(record), getInteger(record + 4), getInteger(record + 8), getInteger(record + 12)};
+        }
+        return {0, 0, 0, 0};
+    }
+    
+    void Patcher::Binary::readLink(const ulong index, Dico& dico) const noexcept
+    {
+        if(index < m_nlinks)
+        {
+            const LinkRecord link = getLink(index);
+            dico[Tags::from]    = {(long)link.from, (long)link.outlet};
+            dico[Tags::to]      = {(long)link.to, (long)link.inlet};
+        }
+    }
+    
+    void Patcher::Binary::read(Dico& dico) const throw(Error&)
+    {
+        Vector objects, links;
+        objects.reserve(m_nobjects);
+        links.reserve(m_nlinks);
+        for(ulong i = 0; i < m_nobjects; i++)
+        {
+            Dico object;
+            readObject(i, object);
+            objects.push_back(object);
+        }
+        for(ulong i = 0; i < m_nlinks; i++)
+        {
+            Dico link;
+            readLink(i, link);
+            links.push_back(link);
+        }
+        Dico subpatcher;
+        subpatcher[Tags::objects]   = objects;
+        subpatcher[Tags::links]     = links;
+        dico[Tags::patcher]         = subpatcher;
+    }
+    
+    void Patcher::Binary::write(string const& path, scPatcher patcher) throw(Error&)
+    {
+        ofstream file(path, ios::binary | ios::trunc);
+        if(!file)
+        {
+            throw Error("The binary patcher " + path + " can't be written.");
+        }
+        Encoder encoder(file);
+        patcher->write(encoder);
+        encoder.finish();
+    }
+    
+    void Patcher::Binary::write(string const& path, Dico const& dico) throw(Error&)
+    {
+        ofstream file(path, ios::binary | ios::trunc);
+        if(!file)
+        {
+            throw Error("The binary patcher " + path + " can't be written.");
+        }
+        Encoder encoder(file);
+        auto it = dico.find(Tags::patcher);
+        if(it != dico.end() && it->second.isDico())
+        {
+            Dico subpatcher(it->second);
+            auto objects = subpatcher.find(Tags::objects);
+            if(objects != subpatcher.end() && objects->second.isVector())
+            {
+                Vector const& atoms = objects->second;
+                for(Vector::size_type i = 0; i < atoms.size(); i++)
+                {
+                    encoder.writeObject(Dico(atoms[i]));
+                }
+            }
+            auto links = subpatcher.find(Tags::links);
+            if(links != subpatcher.end() && links->second.isVector())
+            {
+                Vector const& atoms = links->second;
+                for(Vector::size_type i = 0; i < atoms.size(); i++)
+                {
+                    encoder.writeLink(Dico(atoms[i]));
+                }
+            }
+        }
+        encoder.finish();
+    }
+    
+    // ================================================================================ //
+    //                              PATCHER BINARY ENCODER                              //
+    // ================================================================================ //
+    
+    Patcher::Binary::Encoder::Encoder(ostream& stream) :
+    m_stream(stream)
+    {
+        m_buffer.assign(binary_header_size, '\0');
+        m_stream.write(m_buffer.data(), streamsize(m_buffer.size()));
+        m_buffer.clear();
+    }
+    
+    Patcher::Binary::Encoder::~Encoder()
+    {
+        ;
+    }
+    
+    uint32_t Patcher::Binary::Encoder::getTagIndex(const sTag tag)
+    {
+        auto it = m_indices.find(tag);
+        if(it != m_indices.end())
+        {
+            return it->second;
+        }
+        const uint32_t index = uint32_t(m_tags.size());
+        m_tags.push_back(tag);
+        m_indices[tag] = index;
+        return index;
+    }
+    
+    void Patcher::Binary::Encoder::encode(Atom const& atom)
+    {
+        if(atom.isLong())
+        {
+            m_buffer.push_back(BinaryLong);
+            writeInteger64(m_buffer, uint64_t(int64_t(long(atom))));
+        }
+        else if(atom.isDouble())
+        {
+            const double value = atom;
+            uint64_t bits;
+            memcpy(&bits, &value, sizeof(double));
+            m_buffer.push_back(BinaryDouble);
+            writeInteger64(m_buffer, bits);
+        }
+        else if(atom.isTag())
+        {
+            m_buffer.push_back(BinaryTag);
+            writeInteger(m_buffer, getTagIndex(sTag(atom)));
+        }
+        else if(atom.isVector())
+        {
+            Vector const& atoms = atom;
+            m_buffer.push_back(BinaryVector);
+            writeInteger(m_buffer, uint32_t(atoms.size()));
+            for(Vector::size_type i = 0; i < atoms.size(); i++)
+            {
+                encode(atoms[i]);
+            }
+        }
+        else if(atom.isDico())
+        {
+            m_buffer.push_back(BinaryDico);
+            encode(Dico(atom));
+        }
+        else
+        {
+            m_buffer.push_back(BinaryUndefined);
+        }
+    }
+    
+    void Patcher::Binary::Encoder::encode(Dico const& dico)
+    {
+        writeInteger(m_buffer, uint32_t(dico.size()));
+        for(auto it = dico.begin(); it != dico.end(); ++it)
+        {
+            writeInteger(m_buffer, getTagIndex(it->first));
+            encode(it->second);
+        }
+    }
+    
+    void Patcher::Binary::Encoder::writeObject(Dico const& object)
+    {
+        auto id     = object.find(Tags::id);
+        auto name   = object.find(Tags::name);
+        if(id != object.end() && name != object.end() && name->second.isTag())
+        {
+            m_buffer.clear();
+            encode(object);
+            m_objects.push_back(uint32_t(ulong(id->second)));
+            m_objects.push_back(getTagIndex(sTag(name->second)));
+            m_objects.push_back(uint32_t(m_stream.tellp()));
+            m_objects.push_back(uint32_t(m_buffer.size()));
+            m_stream.write(m_buffer.data(), streamsize(m_buffer.size()));
+        }
+    }
+    
+    void Patcher::Binary::Encoder::writeLink(Dico const& link)
+    {
+        auto from   = link.find(Tags::from);
+        auto to     = link.find(Tags::to);
+        if(from != link.end() && from->second.isVector() && to != link.end() && to->second.isVector())
+        {
+            Vector const& vfrom = from->second;
+            Vector const& vto   = to->second;
+            if(vfrom.size() > 1 && vto.size() > 1)
+            {
+                m_links.push_back(uint32_t(ulong(vfrom[0])));
+                m_links.push_back(uint32_t(ulong(vfrom[1])));
+                m_links.push_back(uint32_t(ulong(vto[0])));
+                m_links.push_back(uint32_t(ulong(vto[1])));
+            }
+        }
+    }
+    
+    void Patcher::Binary::Encoder::finish() throw(Error&)
+    {
+        m_buffer.clear();
+        const uint32_t objects = uint32_t(m_stream.tellp());
+        for(auto value : m_objects)
+        {
+            writeInteger(m_buffer, value);
+        }
+        const uint32_t links = objects + uint32_t(m_buffer.size());
+        for(auto value : m_links)
+        {
+            writeInteger(m_buffer, value);
+        }
+        const uint32_t tags = objects + uint32_t(m_buffer.size());
+        uint32_t offset = tags + uint32_t(m_tags.size()) * 8;
+        for(auto tag : m_tags)
+        {
+            writeInteger(m_buffer, offset);
+            writeInteger(m_buffer, uint32_t(tag->getName().size()));
+            offset += uint32_t(tag->getName().size());
+        }
+        for(auto tag : m_tags)
+        {
+            m_buffer.append(tag->getName());
+        }
+        m_stream.write(m_buffer.data(), streamsize(m_buffer.size()));
+        
+        m_buffer.assign(binary_magic, 4);
+        writeInteger(m_buffer, binary_version);
+        writeInteger(m_buffer, uint32_t(m_objects.size() / 4));
+        writeInteger(m_buffer, objects);
+        writeInteger(m_buffer, uint32_t(m_links.size() / 4));
+        writeInteger(m_buffer, links);
+        writeInteger(m_buffer, uint32_t(m_tags.size()));
+        writeInteger(m_buffer, tags);
+        m_stream.seekp(0);
+        m_stream.write(m_buffer.data(), streamsize(m_buffer.size()));
+        m_stream.seekp(0, ios::end);
+        m_buffer.clear();
+        if(!m_stream)
+        {
+            throw Error("The binary patcher can't be written.");
+        }
+    }
+}
+
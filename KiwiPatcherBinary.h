@@ -0,0 +1,240 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_PATCHER_BINARY__
+#define __DEF_KIWI_PATCHER_BINARY__
+
+#include "KiwiPatch.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                  PATCHER BINARY                                  //
+    // ================================================================================ //
+    
+    //! The binary patcher is a compact and read-only representation of a patcher.
+    /**
+     The binary patcher maps a file in memory and gives a direct access to the records of the objects and the links without parsing the file. The tags are stored once in a table and the objects keep their ids so the links are stored as four integers. A record is only decoded when an object is read.
+     The file starts with a header followed by the data of the objects, the table of the objects, the table of the links and the table of the tags. All the integers are unsigned 32 bits little endian.
+     @see Patcher::add
+     */
+    class Patcher::Binary
+    {
+    public:
+        class Encoder;
+        
+        //! The record of an object.
+        struct ObjectRecord
+        {
+            ulong   id;
+            sTag    name;
+            ulong   size;
+        };
+        
+        //! The record of a link.
+        struct LinkRecord
+        {
+            ulong   from;
+            ulong   outlet;
+            ulong   to;
+            ulong   inlet;
+        };
+        
+    private:
+        const char*         m_data;
+        ulong               m_size;
+        bool                m_mapped;
+        vector<char>        m_buffer;
+        vector<sTag>        m_tags;
+        ulong               m_nobjects;
+        ulong               m_objects;
+        ulong               m_nlinks;
+        ulong               m_links;
+        
+        //! @internal Retrieve an unsigned integer of the file.
+        uint32_t getInteger(const ulong offset) const noexcept;
+        
+        //! @internal Read the header and the tags.
+        void initialize() throw(Error&);
+        
+    public:
+        
+        //! Constructor.
+        /** You should never call this method except if you really know what you're doing.
+         */
+        Binary() noexcept;
+        
+        //! Destructor.
+        /** The function releases the mapping of the file.
+         */
+        ~Binary();
+        
+        //! The binary patcher creation method.
+        /** The function maps a file in memory and reads its header and its table of tags.
+         @param path The path of the file.
+         @return The binary patcher or nullptr if the file isn't valid.
+         */
+        static sBinary create(string const& path);
+        
+        //! The binary patcher creation method.
+        /** The function reads a binary patcher from a block of memory. The memory is copied.
+         @param data The data.
+         @param size The size of the data.
+         @return The binary patcher or nullptr if the data aren't valid.
+         */
+        static sBinary create(const char* data, const ulong size);
+        
+        //! Write a patcher in a binary file.
+        /** The function writes the objects and the links of a patcher in a binary file.
+         @param path    The path of the file.
+         @param patcher The patcher.
+         */
+        static void write(string const& path, scPatcher patcher) throw(Error&);
+        
+        //! Write a patcher's dico in a binary file.
+        /** The function converts the dico of a patcher as written by Patcher::write in a binary file.
+         @param path The path of the file.
+         @param dico The dico.
+         */
+        static void write(string const& path, Dico const& dico) throw(Error&);
+        
+        //! Retrieve the number of objects.
+        /** The function retrieves the number of objects.
+         @return The number of objects.
+         */
+        inline ulong getNumberOfObjects() const noexcept
+        {
+            return m_nobjects;
+        }
+        
+        //! Retrieve the record of an object.
+        /** The function retrieves the record of an object without decoding the object.
+         @param index The index of the object.
+         @return The record of the object.
+         */
+        ObjectRecord getObject(const ulong index) const noexcept;
+        
+        //! Retrieve the data of an object.
+        /** The function retrieves a pointer to the encoded data of an object in the mapped memory.
+         @param index The index of the object.
+         @return The data of the object.
+         */
+        const char* getObjectData(const ulong index) const noexcept;
+        
+        //! Read an object.
+        /** The function decodes the record of an object in a dico.
+         @param index The index of the object.
+         @param dico  The dico.
+         */
+        void readObject(const ulong index, Dico& dico) const throw(Error&);
+        
+        //! Retrieve the number of links.
+        /** The function retrieves the number of links.
+         @return The number of links.
+         */
+        inline ulong getNumberOfLinks() const noexcept
+        {
+            return m_nlinks;
+        }
+        
+        //! Retrieve the record of a link.
+        /** The function retrieves the record of a link.
+         @param index The index of the link.
+         @return The record of the link.
+         */
+        LinkRecord getLink(const ulong index) const noexcept;
+        
+        //! Read a link.
+        /** The function writes the record of a link in a dico.
+         @param index The index of the link.
+         @param dico  The dico.
+         */
+        void readLink(const ulong index, Dico& dico) const noexcept;
+        
+        //! Read the patcher.
+        /** The function converts the binary patcher to the dico of a patcher as read by Patcher::create.
+         @param dico  The dico.
+         */
+        void read(Dico& dico) const throw(Error&);
+    };
+    
+    // ================================================================================ //
+    //                              PATCHER BINARY ENCODER                              //
+    // ================================================================================ //
+    
+    //! The binary encoder writes a binary patcher in a stream.
+    /**
+     The encoder is a patcher's writer, the objects are encoded and written in the stream as they are received. Only the tables of the objects, the links and the tags are kept in memory until the end.
+     @see Patcher::write
+     */
+    class Patcher::Binary::Encoder : public Patcher::Writer
+    {
+    private:
+        ostream&                        m_stream;
+        vector<uint32_t>                m_objects;
+        vector<uint32_t>                m_links;
+        vector<sTag>                    m_tags;
+        unordered_map<sTag, uint32_t>   m_indices;
+        string                          m_buffer;
+        
+        //! @internal Encoding methods.
+        uint32_t getTagIndex(const sTag tag);
+        void encode(Atom const& atom);
+        void encode(Dico const& dico);
+        
+    public:
+        
+        //! Constructor.
+        /** The function writes a blank header in the stream.
+         @param stream The stream.
+         */
+        Encoder(ostream& stream);
+        
+        //! Destructor.
+        /** You should call finish before the destruction.
+         */
+        ~Encoder();
+        
+        //! Encode an object.
+        /** The function encodes an object and writes it in the stream.
+         @param object The dico of the object.
+         */
+        void writeObject(Dico const& object) override;
+        
+        //! Encode a link.
+        /** The function adds a link to the table of the links.
+         @param link The dico of the link.
+         */
+        void writeLink(Dico const& link) override;
+        
+        //! Finish the encoding.
+        /** The function writes the tables and the header. The stream must be seekable.
+         */
+        void finish() throw(Error&);
+    };
+}
+
+
+#endif
+
+
@@ -68,6 +68,19 @@ namespace Kiwi
         }
     }
     
+    void Patcher::Controller::objectsCreated(sPatcher patcher, vector<sObject> objects)
+    {
+        if (patcher && patcher == m_patcher)
+        {
+            lock_guard<mutex> guard(m_mutex);
+            m_object_handlers.reserve(m_object_handlers.size() + objects.size());
+            for(auto object : objects)
+            {
+                m_object_handlers.push_back(make_shared<Patcher::Controller::ObjectHandler>(m_patcher, object));
+            }
+        }
+    }
+    
     void Patcher::Controller::objectRemoved(sPatcher patcher, sObject object)
     {
         if (patcher && object && patcher == m_patcher)
@@ -345,7 +358,7 @@ namespace Kiwi
         {
             bool changed = false;
             lock_guard<mutex> guard(m_mutex);
-            for(auto object : patcher->getObjects())
+            for(auto object : *patcher->getObjectsSnapshot())
             {
                 if(object && m_objects.insert(object).second)
                 {
@@ -374,7 +387,7 @@ namespace Kiwi
             bool changed = false;
             lock_guard<mutex> guard(m_mutex);
             
-            for(auto link : patcher->getLinks())
+            for(auto link : *patcher->getLinksSnapshot())
             {
                 if(link && m_links.insert(link).second)
                 {
@@ -750,7 +763,7 @@ namespace Kiwi
                     //knockObjects(getBounds(), lassoObjects);
                     
                     lock_guard<mutex> guard(m_mutex);
-                    for(auto object : patcher->getObjects())
+                    for(auto object : *patcher->getObjectsSnapshot())
                     {
                         if(object)
                         {
@@ -778,7 +791,7 @@ namespace Kiwi
                     //knockObjects(getBounds(), lassoLinks);
                     
                     lock_guard<mutex> guard(m_mutex);
-                    for(auto link : patcher->getLinks())
+                    for(auto link : *patcher->getLinksSnapshot())
                     {
                         if(link)
                         {
@@ -232,6 +232,12 @@ namespace Kiwi
          */
         void objectCreated(sPatcher patcher, sObject object) override;
         
+        //! Receive the notification that a set of objects has been created.
+        /** The function is called by the patcher when a set of objects has been added.
+         @param objects     The objects.
+         */
+        void objectsCreated(sPatcher patcher, vector<sObject> objects) override;
+        
         //! Receive the notification that an object has been removed.
         /** The function is called by the patcher when an object has been removed.
          @param object     The object.
@@ -0,0 +1,98 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "KiwiProfiler.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      PROFILER                                    //
+    // ================================================================================ //
+    
+    void Profiler::record(Object::Records& records, const unsigned long long value) noexcept
+    {
+        records.count.fetch_add(1, memory_order_relaxed);
+        records.total.fetch_add(value, memory_order_relaxed);
+        unsigned long long maximum = records.maximum.load(memory_order_relaxed);
+        while(value > maximum && !records.maximum.compare_exchange_weak(maximum, value, memory_order_relaxed))
+        {
+            ;
+        }
+    }
+    
+    void Profiler::clear(Object::Records& records) noexcept
+    {
+        records.count.store(0, memory_order_relaxed);
+        records.total.store(0, memory_order_relaxed);
+        records.maximum.store(0, memory_order_relaxed);
+    }
+    
+    void Profiler::receive(const Object* object, const Clock::duration duration) noexcept
+    {
+        record(object->m_records, (unsigned long long)chrono::duration_cast<chrono::nanoseconds>(duration).count());
+    }
+    
+    void Profiler::send(const Object::Outlet* outlet, const ulong connections) noexcept
+    {
+        record(outlet->m_records, connections);
+    }
+    
+    void Profiler::reset(vector<sObject> const& objects) noexcept
+    {
+        for(auto const& object : objects)
+        {
+            clear(object->m_records);
+            for(auto const& outlet : object->getOutlets())
+            {
+                clear(outlet->m_records);
+            }
+        }
+    }
+    
+    void Profiler::collect(vector<sObject> const& objects, vector<ObjectProfile>& oprofiles, vector<OutletProfile>& iprofiles)
+    {
+        typedef chrono::duration<double, milli> milliseconds;
+        for(auto const& object : objects)
+        {
+            Object::Records const& records = object->m_records;
+            const ulong messages = records.count.load(memory_order_relaxed);
+            if(messages)
+            {
+                oprofiles.push_back({object, messages,
+                    chrono::duration_cast<milliseconds>(chrono::nanoseconds(records.total.load(memory_order_relaxed))).count(),
+                    chrono::duration_cast<milliseconds>(chrono::nanoseconds(records.maximum.load(memory_order_relaxed))).count()});
+            }
+            
+            const vector<Object::sOutlet> outlets = object->getOutlets();
+            for(vector<Object::sOutlet>::size_type i = 0; i < outlets.size(); i++)
+            {
+                Object::Records const& orecords = outlets[i]->m_records;
+                const ulong omessages = orecords.count.load(memory_order_relaxed);
+                if(omessages)
+                {
+                    iprofiles.push_back({object, ulong(i), omessages, ulong(orecords.total.load(memory_order_relaxed)), ulong(orecords.maximum.load(memory_order_relaxed))});
+                }
+            }
+        }
+    }
+}
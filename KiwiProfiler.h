@@ -0,0 +1,125 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_PROFILER__
+#define __DEF_KIWI_PROFILER__
+
+#include "KiwiObject.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      PROFILER                                    //
+    // ================================================================================ //
+    
+    //! The profiler counts the messages of the objects and the outlets.
+    /**
+     The profiler is disabled by default, when it's enabled the outlets record the number of messages they send and the number of connections they reach, and the objects record the number of messages they receive and the time spent in their receive methods. With the recursive dispatch the time includes the objects that receive the messages sent during the reception, with the iterative dispatch it doesn't. The records are kept by the objects and the outlets themselves and updated with relaxed atomic operations, so recording a message never locks and the records are freed with their object.
+     @see Instance::getProfiles, Instance::resetProfiles, Instance::postProfiles
+     */
+    class Profiler
+    {
+    public:
+        //! The profile of an object.
+        struct ObjectProfile
+        {
+            sObject object;
+            ulong   messages;
+            double  time;
+            double  maximum;
+        };
+        
+        //! The profile of an outlet.
+        struct OutletProfile
+        {
+            sObject object;
+            ulong   index;
+            ulong   messages;
+            ulong   connections;
+            ulong   maximum;
+        };
+        
+    private:
+        static inline atomic_bool& getState() noexcept
+        {
+            static atomic_bool _state(false);
+            return _state;
+        }
+        
+        //! @internal Add a value to the records or clear them.
+        static void record(Object::Records& records, const unsigned long long value) noexcept;
+        static void clear(Object::Records& records) noexcept;
+        
+    public:
+        typedef chrono::steady_clock Clock;
+        
+        //! Enable or disable the profiler.
+        /** The function enables or disables the records of the objects and the outlets.
+         @param state True to enable the profiler, false to disable it.
+         */
+        static inline void setEnabled(const bool state) noexcept
+        {
+            getState() = state;
+        }
+        
+        //! Retrieve if the profiler is enabled.
+        /** The function retrieves if the records of the objects and the outlets are enabled.
+         @return True if the profiler is enabled, otherwise false.
+         */
+        static inline bool isEnabled() noexcept
+        {
+            return getState().load(memory_order_relaxed);
+        }
+        
+        //! Record the reception of a message by an object.
+        /** The function records a message received by an object and the time spent in the receive method.
+         @param object   The object.
+         @param duration The time spent in the receive method.
+         */
+        static void receive(const Object* object, const Clock::duration duration) noexcept;
+        
+        //! Record the sending of a message by an outlet.
+        /** The function records a message sent by an outlet and the number of connections it reaches.
+         @param outlet      The outlet.
+         @param connections The number of connections.
+         */
+        static void send(const Object::Outlet* outlet, const ulong connections) noexcept;
+        
+        //! Reset the records of a set of objects.
+        /** The function resets the records of the objects and of their outlets.
+         @param objects The objects.
+         */
+        static void reset(vector<sObject> const& objects) noexcept;
+        
+        //! Retrieve the profiles of a set of objects.
+        /** The function retrieves the profiles of the objects and of their outlets that have records.
+         @param objects The objects.
+         @param oprofiles The profiles of the objects.
+         @param iprofiles The profiles of the outlets.
+         */
+        static void collect(vector<sObject> const& objects, vector<ObjectProfile>& oprofiles, vector<OutletProfile>& iprofiles);
+    };
+}
+
+
+#endif
@@ -0,0 +1,150 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "KiwiScheduler.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      SCHEDULER                                   //
+    // ================================================================================ //
+    
+    static ulong getPowerOfTwo(const ulong size) noexcept
+    {
+        ulong power = 1;
+        while(power < size)
+        {
+            power <<= 1;
+        }
+        return power;
+    }
+    
+    Scheduler::Scheduler(const ulong capacity, const ulong natoms) :
+    m_messages(new Message[getPowerOfTwo(capacity)]),
+    m_mask(getPowerOfTwo(capacity) - 1),
+    m_head(0),
+    m_tail(0),
+    m_running(true),
+    m_sleeping(false)
+    {
+        for(ulong i = 0; i <= m_mask; i++)
+        {
+            m_messages[i].sequence = i;
+            m_messages[i].index = 0;
+            m_messages[i].atoms.reserve((Vector::size_type)natoms);
+        }
+        m_thread = thread(&Scheduler::run, this);
+    }
+    
+    Scheduler::~Scheduler()
+    {
+        m_running = false;
+        m_semaphore.post();
+        if(m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+    
+    bool Scheduler::post(scObject object, const ulong index, Vector const& atoms) noexcept
+    {
+        ulong position = m_tail.load(memory_order_relaxed);
+        Message* message;
+        while(true)
+        {
+            message = &m_messages[position & m_mask];
+            const long diff = long(message->sequence.load(memory_order_acquire)) - long(position);
+            if(!diff)
+            {
+                if(m_tail.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if(diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = m_tail.load(memory_order_relaxed);
+            }
+        }
+        
+        message->object = object;
+        message->index  = index;
+        message->atoms  = atoms;
+        message->sequence.store(position + 1, memory_order_release);
+        
+        // The scheduler thread checks the queue after it announces that it sleeps, so either it sees the message or the post sees it sleeping.
+        atomic_thread_fence(memory_order_seq_cst);
+        if(m_sleeping.load(memory_order_relaxed) && m_sleeping.exchange(false))
+        {
+            m_semaphore.post();
+        }
+        return true;
+    }
+    
+    ulong Scheduler::process() noexcept
+    {
+        ulong position = m_head.load(memory_order_relaxed);
+        ulong count = 0;
+        while(true)
+        {
+            Message& message = m_messages[position & m_mask];
+            if(message.sequence.load(memory_order_acquire) != position + 1)
+            {
+                break;
+            }
+            
+            if(message.object)
+            {
+                message.object->send(message.index, message.atoms);
+            }
+            message.object.reset();
+            message.atoms.clear();
+            message.sequence.store(position + m_mask + 1, memory_order_release);
+            m_head.store(++position, memory_order_relaxed);
+            count++;
+        }
+        return count;
+    }
+    
+    void Scheduler::run() noexcept
+    {
+        while(m_running)
+        {
+            if(!process())
+            {
+                m_sleeping = true;
+                atomic_thread_fence(memory_order_seq_cst);
+                if(!process() && m_running)
+                {
+                    m_semaphore.wait();
+                }
+                m_sleeping = false;
+            }
+        }
+    }
+}
+
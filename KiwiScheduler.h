@@ -0,0 +1,97 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_SCHEDULER__
+#define __DEF_KIWI_SCHEDULER__
+
+#include "KiwiObject.h"
+#include "KiwiSemaphore.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      SCHEDULER                                   //
+    // ================================================================================ //
+    
+    //! The scheduler delivers the messages posted by the other threads.
+    /**
+     The scheduler owns a bounded queue of messages and a thread that delivers them. Any thread can post a message without locking: the queue is a ring of preallocated messages where the producers reserve a position with an atomic counter and the scheduler thread is the only consumer. Posting never allocates as long as the number of atoms fits the capacity reserved for each message and the atoms don't own a vector or a dico, so the dsp thread can use it to emit control messages. The scheduler thread sleeps on a semaphore when the queue is empty and a post only wakes it up if it sleeps. The objects are kept alive until their messages have been delivered and they are released by the scheduler thread.
+     @see Object::defer
+     */
+    class Scheduler
+    {
+    private:
+        //! @internal A message of the queue.
+        struct Message
+        {
+            atomic_ulong    sequence;
+            scObject        object;
+            ulong           index;
+            Vector          atoms;
+        };
+        
+        const unique_ptr<Message[]> m_messages;
+        const ulong                 m_mask;
+        atomic_ulong                m_head;
+        atomic_ulong                m_tail;
+        atomic_bool                 m_running;
+        atomic_bool                 m_sleeping;
+        Semaphore                   m_semaphore;
+        thread                      m_thread;
+        
+        //! @internal The loop of the scheduler thread.
+        void run() noexcept;
+        
+    public:
+        
+        //! Constructor.
+        /** The function allocates the messages and starts the scheduler thread.
+         @param capacity The number of messages of the queue, rounded up to a power of two.
+         @param natoms   The number of atoms reserved for each message.
+         */
+        Scheduler(const ulong capacity = 1024, const ulong natoms = 8);
+        
+        //! Destructor.
+        /** The function stops the scheduler thread, the messages that haven't been delivered are discarded.
+         */
+        ~Scheduler();
+        
+        //! Post a message.
+        /** The function posts a message that will be sent via an outlet of an object by the scheduler thread. The function never blocks, it fails if the queue is full.
+         @param object The object.
+         @param index  The index of the outlet.
+         @param atoms  The atoms.
+         @return True if the message has been posted, false if the queue is full.
+         */
+        bool post(scObject object, const ulong index, Vector const& atoms) noexcept;
+        
+        //! Deliver the pending messages.
+        /** The function delivers the messages in the order they have been posted. It should only be called by the scheduler thread.
+         @return The number of messages delivered.
+         */
+        ulong process() noexcept;
+    };
+}
+
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#include "KiwiSemaphore.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#else
+#include <cerrno>
+#include <semaphore.h>
+#endif
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      SEMAPHORE                                   //
+    // ================================================================================ //
+    
+    class Semaphore::Handle
+    {
+    public:
+#if defined(_WIN32) || defined(_WIN64)
+        HANDLE                  handle;
+#elif defined(__APPLE__)
+        dispatch_semaphore_t    handle;
+#else
+        sem_t                   handle;
+#endif
+    };
+    
+    Semaphore::Semaphore() :
+    m_handle(new Handle())
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        m_handle->handle = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+#elif defined(__APPLE__)
+        m_handle->handle = dispatch_semaphore_create(0);
+#else
+        sem_init(&m_handle->handle, 0, 0);
+#endif
+    }
+    
+    Semaphore::~Semaphore()
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        CloseHandle(m_handle->handle);
+#elif defined(__APPLE__)
+        dispatch_release(m_handle->handle);
+#else
+        sem_destroy(&m_handle->handle);
+#endif
+    }
+    
+    void Semaphore::post(const ulong count) noexcept
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        if(count)
+        {
+            ReleaseSemaphore(m_handle->handle, LONG(count), NULL);
+        }
+#else
+        for(ulong i = 0; i < count; i++)
+        {
+#if defined(__APPLE__)
+            dispatch_semaphore_signal(m_handle->handle);
+#else
+            sem_post(&m_handle->handle);
+#endif
+        }
+#endif
+    }
+    
+    void Semaphore::wait() noexcept
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        WaitForSingleObject(m_handle->handle, INFINITE);
+#elif defined(__APPLE__)
+        dispatch_semaphore_wait(m_handle->handle, DISPATCH_TIME_FOREVER);
+#else
+        while(sem_wait(&m_handle->handle) == -1 && errno == EINTR)
+        {
+            ;
+        }
+#endif
+    }
+}
+
@@ -0,0 +1,74 @@
+/*
+ ==============================================================================
+ 
+ This file is part of the KIWI library.
+ Copyright (c) 2014 Pierre Guillot & Eliott Paris.
+ 
+ Permission is granted to use this software under the terms of either:
+ a) the GPL v2 (or any later version)
+ b) the Affero GPL v3
+ 
+ Details of these licenses can be found at: www.gnu.org/licenses
+ 
+ KIWI is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ 
+ ------------------------------------------------------------------------------
+ 
+ To release a closed-source product which uses KIWI, contact : guillotpierre6@gmail.com
+ 
+ ==============================================================================
+*/
+
+#ifndef __DEF_KIWI_SEMAPHORE__
+#define __DEF_KIWI_SEMAPHORE__
+
+#include "../KiwiCore/KiwiCore.h"
+
+namespace Kiwi
+{
+    // ================================================================================ //
+    //                                      SEMAPHORE                                   //
+    // ================================================================================ //
+    
+    //! The semaphore wakes up the threads that wait for some work.
+    /**
+     The semaphore is a counting semaphore of the system. Posting never takes a lock of the process so the dsp thread can wake up the executor and the scheduler threads.
+     @see Executor, Scheduler
+     */
+    class Semaphore
+    {
+    private:
+        //! @internal The semaphore of the system.
+        class Handle;
+        
+        const unique_ptr<Handle> m_handle;
+        
+    public:
+        
+        //! Constructor.
+        /** The function creates a semaphore with a count of zero.
+         */
+        Semaphore();
+        
+        //! Destructor.
+        /** The function releases the semaphore, no thread should wait on it.
+         */
+        ~Semaphore();
+        
+        //! Post the semaphore.
+        /** The function increments the count of the semaphore and wakes up as many waiting threads.
+         @param count The number of increments.
+         */
+        void post(const ulong count = 1) noexcept;
+        
+        //! Wait on the semaphore.
+        /** The function blocks until the count of the semaphore is positive then decrements it.
+         */
+        void wait() noexcept;
+    };
+}
+
+
+#endif